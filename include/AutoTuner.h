@@ -0,0 +1,70 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include "Simulation.h"
+
+// Performance settings chosen by the auto-tuner
+struct TuningConfig {
+    int threadCount = 0;            // Worker threads (0 = all hardware threads)
+    int tileSize = 4;               // Tile edge length in grid cells
+    float cellSizeScale = 1.0f;     // Grid cell size relative to the smoothing radius
+    int reorderInterval = 0;        // Steps between particle reorders (0 = never)
+};
+
+// Picks the fastest performance settings for a scene on this machine.
+//
+// Calibration runs a scratch copy of the scene for a few steps per
+// candidate setting, one setting at a time (threads, cell size, tile size,
+// reorder interval), keeping the fastest value of each before moving on.
+// Results are cached per machine and scene signature so later startups
+// only need a file lookup.
+//
+// Settings that are not tuned keep the simulation's current value. The
+// reorder interval is not tuned unless enabled: reordering permutes
+// getParticles(), so consumers that follow particles by index across
+// frames (trajectory recording, shared memory export) would break.
+class AutoTuner {
+public:
+    // cachePath empty uses autotune.txt in the user cache directory
+    explicit AutoTuner(const std::string& cachePath = std::string());
+
+    // Apply cached settings for the simulation's current scene; false if none
+    bool applyCached(Simulation& simulation);
+
+    // Calibrate (or use the cache unless force is set), apply and cache the result
+    TuningConfig tune(Simulation& simulation, float dt, bool force = false);
+
+    // Steps timed per candidate setting
+    void setCalibrationSteps(int steps) { calibrationSteps = steps > 0 ? steps : 1; }
+
+    // Which settings are tuned (threads by default, reorder interval only on request)
+    void setTuneThreads(bool enabled) { tuneThreads = enabled; }
+    void setTuneReorder(bool enabled) { tuneReorder = enabled; }
+
+    // Apply settings to a simulation
+    static void apply(Simulation& simulation, const TuningConfig& config);
+
+    // Cache key for the current machine and the simulation's scene
+    static std::string signature(const Simulation& simulation);
+
+private:
+    // Cache key: scene signature plus the settings held fixed
+    std::string cacheKey(const Simulation& simulation) const;
+
+    // Replace settings that are not tuned with the simulation's current values
+    void keepFixedSettings(const Simulation& simulation, TuningConfig& config) const;
+
+    // Average time per step of the scratch simulation with a config
+    double measure(Simulation& scratch, const std::vector<Particle>& start,
+                   const TuningConfig& config, float dt, int steps);
+
+    // Cache file access
+    bool loadCached(const std::string& key, TuningConfig& config) const;
+    void storeCached(const std::string& key, const TuningConfig& config) const;
+
+    std::string cachePath;
+    int calibrationSteps;
+    bool tuneThreads;
+    bool tuneReorder;
+};
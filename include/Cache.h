@@ -0,0 +1,28 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+namespace Cache {
+    // Per-user cache directory ($SPH_CACHE_DIR, $XDG_CACHE_HOME/sph-fluid-simulation
+    // or ~/.cache/sph-fluid-simulation); created on demand. Empty if unavailable.
+    std::string directory();
+
+    // 64-bit FNV-1a hash for building cache keys
+    std::uint64_t hash(const void* data, size_t size, std::uint64_t seed = 14695981039346656037ull);
+    std::uint64_t hash(const std::string& text, std::uint64_t seed = 14695981039346656037ull);
+
+    // Hash as a 16-digit hex string
+    std::string toHex(std::uint64_t value);
+
+    // Replace path with data via a uniquely named temporary file and a rename,
+    // so concurrent readers and writers never see a partial file
+    bool writeFileAtomically(const std::string& path, const void* data, size_t size);
+
+    // Mark a cache file as recently used
+    void touch(const std::string& path);
+
+    // Delete all but the keep most recently used files in directory whose
+    // names start with prefix and end with suffix
+    void prune(const std::string& directory, const std::string& prefix, const std::string& suffix, size_t keep);
+}
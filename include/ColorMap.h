@@ -0,0 +1,15 @@
+#pragma once
+
+#include <algorithm>
+#include <glm/glm.hpp>
+
+namespace ColorMap {
+    // Density at which particles reach full brightness
+    constexpr float MAX_DENSITY = 1500.0f;
+    
+    // Map density to color (blue to cyan to white)
+    inline glm::vec3 densityToColor(float density) {
+        float normalizedDensity = std::min(density / MAX_DENSITY, 1.0f);
+        return glm::vec3(normalizedDensity, 0.5f + 0.5f * normalizedDensity, 1.0f);
+    }
+} 
\ No newline at end of file
@@ -0,0 +1,21 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+class ThreadPool;
+
+namespace ImageWriter {
+    // Write 8-bit RGB pixels (top row first) as a binary PPM image
+    bool writePPM(const std::string& path, int width, int height, const std::uint8_t* rgb);
+
+    // Write 8-bit RGB pixels (top row first) as a PNG image.
+    // With a thread pool, horizontal bands are compressed in parallel.
+    bool writePNG(const std::string& path, int width, int height, const std::uint8_t* rgb,
+                  ThreadPool* pool = nullptr);
+
+    // Encode 8-bit RGB pixels as a PNG file in memory
+    void encodePNG(int width, int height, const std::uint8_t* rgb, std::vector<std::uint8_t>& out,
+                   ThreadPool* pool = nullptr);
+}
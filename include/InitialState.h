@@ -0,0 +1,32 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <glm/glm.hpp>
+
+// How Simulation::initialize places particles
+enum class InitMode {
+    Random,         // Uniformly random in the spawn region
+    Lattice,        // Square lattice at rest-density spacing
+    PoissonDisk     // Poisson-disk sampling at rest-density spacing
+};
+
+namespace InitialState {
+    // Square-lattice spacing at which the Poly6 density equals restDensity
+    float restSpacing(float mass, float restDensity, float smoothingRadius);
+
+    // Square lattice of count points with the given spacing. The block takes
+    // the aspect ratio of the spawn region, is centered on it horizontally
+    // and sits on its bottom edge, staying inside the domain.
+    std::vector<glm::vec2> lattice(int count, const glm::vec2& regionMin, const glm::vec2& regionMax,
+                                   const glm::vec2& domain, float spacing);
+
+    // Poisson-disk samples (Bridson's algorithm) with minimum distance spacing,
+    // placed like lattice(); deterministic for a given seed
+    std::vector<glm::vec2> poissonDisk(int count, const glm::vec2& regionMin, const glm::vec2& regionMax,
+                                       const glm::vec2& domain, float spacing, unsigned int seed);
+
+    // Warm-start cache files holding particle positions
+    bool load(const std::string& path, size_t count, std::vector<glm::vec2>& positions);
+    bool store(const std::string& path, const std::vector<glm::vec2>& positions);
+}
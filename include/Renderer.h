@@ -17,6 +17,9 @@ public:
     // Render particles
     void render(const std::vector<Particle>& particles);
     
+    // Render pre-packed positions and colors (e.g. from Simulation render packing)
+    void render(const std::vector<glm::vec2>& positions, const std::vector<glm::vec3>& colors);
+    
     // Check if window should close
     bool shouldClose() const;
     
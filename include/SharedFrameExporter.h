@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "Particle.h"
+#include "Simulation.h"
+#include "sph_shm.h"
+
+// Publishes frames into a POSIX shared-memory ring for co-located readers.
+//
+// Each publish() copies the particle array into the next slot with a single
+// memcpy (the slot layout is the Particle struct itself, described in the
+// segment header) and bumps the slot's sequence counter. Readers use the C
+// API in sph_shm.h and never block the producer. If a frame outgrows the
+// slot capacity the segment is marked closed and recreated larger, and
+// readers re-attach.
+//
+// A name that is already in use by a live producer is not taken over;
+// open() fails instead. Segments left behind by a producer that closed
+// them or exited without cleaning up are replaced.
+class SharedFrameExporter {
+public:
+    SharedFrameExporter();
+    ~SharedFrameExporter();
+
+    // Create the segment (name like "/sph_frames"); false if another producer owns it
+    bool open(const std::string& name, uint32_t maxParticles, uint32_t slotCount = 4);
+
+    // Mark the segment closed, unmap and unlink it
+    void close();
+
+    // Publish particles and parameters as the next frame
+    bool publish(const std::vector<Particle>& particles, const sph_shm_params& params);
+    bool publish(const Simulation& simulation);
+
+    bool isOpen() const { return header != nullptr; }
+    uint64_t getFrameCount() const { return nextFrame; }
+
+private:
+    // Map a new segment with the given capacity
+    bool create(uint32_t maxParticles, uint32_t slotCount);
+
+    // Unmap and unlink the current segment
+    void destroy();
+
+    // True if the existing segment with this name has no live producer
+    static bool isStale(const std::string& name);
+
+    std::string name;
+    unsigned char* base;
+    size_t size;
+    sph_shm_header* header;
+    uint64_t nextFrame;
+};
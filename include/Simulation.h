@@ -1,8 +1,13 @@
 #pragma once
 
+#include <cstdint>
+#include <string>
 #include <vector>
 #include <glm/glm.hpp>
 #include "Particle.h"
+#include "InitialState.h"
+#include "TaskGraph.h"
+#include "ThreadPool.h"
 
 class Simulation {
 public:
@@ -12,12 +17,26 @@ public:
     // Initialize the simulation with a given number of particles
     void initialize(int numParticles);
     
+    // Let particles settle without gravity, then reset velocities
+    void relax(int steps, float dt);
+    
     // Update the simulation by one time step
     void update(float dt);
     
     // Get the particles for rendering
     const std::vector<Particle>& getParticles() const { return particles; }
     
+    // Replace the particle state (e.g. to restore a snapshot)
+    void setParticles(const std::vector<Particle>& newParticles);
+    
+    // Container dimensions
+    float getWidth() const { return width; }
+    float getHeight() const { return height; }
+    
+    // Packed render buffers written during update (see setRenderPacking)
+    const std::vector<glm::vec2>& getPackedPositions() const { return packedPositions; }
+    const std::vector<glm::vec3>& getPackedColors() const { return packedColors; }
+    
     // Simulation parameters
     void setGravity(const glm::vec2& g) { gravity = g; }
     void setViscosity(float v) { viscosity = v; }
@@ -34,18 +53,61 @@ public:
     float getSmoothingRadius() const { return smoothingRadius; }
     float getDampingCoefficient() const { return dampingCoefficient; }
     
+    // Initial state settings
+    void setInitMode(InitMode mode) { initMode = mode; }
+    void setRelaxationSteps(int steps) { relaxationSteps = steps > 0 ? steps : 0; }
+    void setWarmStartCache(bool enabled) { warmStartCache = enabled; }
+    
+    InitMode getInitMode() const { return initMode; }
+    int getRelaxationSteps() const { return relaxationSteps; }
+    bool getWarmStartCache() const { return warmStartCache; }
+    
+    // Performance settings
+    void setThreadCount(int threads) { pool.setThreadCount(threads); }
+    void setTileSize(int cells) { tileSize = cells > 0 ? cells : 1; }
+    void setCellSizeScale(float scale) { cellSizeScale = scale >= 1.0f ? scale : 1.0f; }
+    void setReorderInterval(int steps) { reorderInterval = steps > 0 ? steps : 0; }
+    void setRenderPacking(bool enabled) { renderPacking = enabled; }
+    
+    int getThreadCount() const { return pool.getThreadCount(); }
+    int getTileSize() const { return tileSize; }
+    float getCellSizeScale() const { return cellSizeScale; }
+    int getReorderInterval() const { return reorderInterval; }
+    bool getRenderPacking() const { return renderPacking; }
+
 private:
-    // Compute density and pressure for all particles
-    void computeDensityPressure();
+    // Place particles on a lattice or Poisson-disk samples and relax them,
+    // using the warm-start cache when possible
+    void initializeRelaxed(int numParticles);
+    
+    // Warm-start cache file for the current setup
+    std::string warmStartPath(int numParticles) const;
     
-    // Compute forces for all particles
-    void computeForces();
+    // Bin particles into grid cells and rebuild the task graph if the grid changed
+    void rebuildGrid();
     
-    // Integrate particles forward in time
-    void integrate(float dt);
+    // Build the per-tile task graph for the current grid
+    void buildTaskGraph();
+    
+    // Grid cell containing a position
+    std::uint32_t cellOf(const glm::vec2& position) const;
+    
+    // Compute density and pressure for the particles of one tile
+    void computeDensityPressure(int tile);
+    
+    // Compute forces for the particles of one tile
+    void computeForces(int tile);
+    
+    // Fused pass for one tile: integrate, handle boundaries, bin into the
+    // next step's grid cell and pack render buffers
+    void integrate(int tile);
     
     // Handle boundary conditions
-    void handleBoundaries();
+    void handleBoundaries(Particle& p);
+    
+    // Call body(i) for every particle index in the cells of a tile
+    template <typename Body>
+    void forEachInTile(int tile, Body body);
     
     // Container dimensions
     float width;
@@ -53,6 +115,7 @@ private:
     
     // Particles
     std::vector<Particle> particles;
+    std::vector<Particle> reorderScratch;
     
     // Simulation parameters
     glm::vec2 gravity;              // Gravity force
@@ -61,4 +124,38 @@ private:
     float restDensity;              // Rest density
     float smoothingRadius;          // Smoothing radius for kernels
     float dampingCoefficient;       // Damping coefficient for boundary collisions
+    
+    // Uniform grid over the particles' bounding box (cell size >= smoothing radius)
+    float cellSize;
+    glm::vec2 gridOrigin;
+    int gridX;
+    int gridY;
+    std::vector<std::uint32_t> cellStart;       // Offsets into cellParticles, one per cell + 1
+    std::vector<std::uint32_t> cellParticles;   // Particle indices sorted by cell
+    std::vector<std::uint32_t> particleCell;    // Cell of each particle
+    std::vector<std::uint32_t> cellCursor;      // Scratch for the counting sort
+    bool particleCellValid;                     // particleCell matches the current grid
+    
+    // Tiles of tileSize x tileSize cells, scheduled as a task graph
+    int tilesX;
+    int tilesY;
+    TaskGraph taskGraph;
+    ThreadPool pool;
+    float stepDt;
+    
+    // Packed render buffers
+    std::vector<glm::vec2> packedPositions;
+    std::vector<glm::vec3> packedColors;
+    
+    // Initial state settings
+    InitMode initMode;              // Particle placement on initialize
+    int relaxationSteps;            // Relaxation steps after placement
+    bool warmStartCache;            // Cache relaxed states on disk
+    
+    // Performance settings
+    int tileSize;                   // Tile edge length in cells
+    float cellSizeScale;            // Cell size relative to the smoothing radius
+    int reorderInterval;            // Steps between particle reorders by cell (0 = never)
+    bool renderPacking;             // Pack render buffers during update
+    long long stepCount;
 }; 
\ No newline at end of file
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "Particle.h"
+#include "ThreadPool.h"
+
+// Where rendered frames go
+enum class FrameOutput {
+    None,           // Keep the frame in memory only
+    PPM,            // Numbered PPM files
+    PNG,            // Numbered PNG files
+    RawStdout       // Raw RGB24 frames on stdout (for piping into an encoder)
+};
+
+// Offscreen CPU renderer with the same render() interface as Renderer.
+//
+// Particles are binned into screen tiles and the tiles are rasterized in
+// parallel, each one drawing its particles in index order so the image
+// matches the OpenGL point sprites regardless of thread count.
+class SoftwareRenderer {
+public:
+    SoftwareRenderer(int width, int height, int threadCount = 0);
+
+    // Allocate the framebuffer
+    bool initialize();
+
+    // Render particles into the framebuffer and emit the frame; false if writing it failed
+    bool render(const std::vector<Particle>& particles);
+
+    // Configure frame output; pattern is a printf-style path such as "frames/frame_%05d".
+    // Returns false and keeps the previous settings if the pattern is invalid.
+    bool setOutput(FrameOutput output, const std::string& pattern = "frame_%05d");
+
+    // True if pattern has exactly one integer conversion (%d or %i with optional
+    // flags, width and precision); "%%" is a literal percent sign
+    static bool isValidPattern(const std::string& pattern);
+
+    // Rendering options
+    void setPointSize(float size) { pointSize = size; }
+    void setTileSize(int size);
+    void setThreadCount(int threadCount) { pool.setThreadCount(threadCount); }
+
+    // Framebuffer access (RGB24, top row first)
+    const std::vector<std::uint8_t>& getFramebuffer() const { return framebuffer; }
+    int getWidth() const { return width; }
+    int getHeight() const { return height; }
+    int getFrameNumber() const { return frameNumber; }
+
+private:
+    // Sort particle indices into the tiles their sprites overlap
+    void binParticles(const std::vector<Particle>& particles);
+
+    // Rasterize all particles binned into one tile
+    void rasterizeTile(int tile, const std::vector<Particle>& particles);
+
+    // Write the framebuffer to the configured output
+    bool writeFrame();
+
+    // Framebuffer dimensions
+    int width;
+    int height;
+
+    // RGB24 framebuffer
+    std::vector<std::uint8_t> framebuffer;
+
+    // Tile grid
+    int tileSize;
+    int tilesX;
+    int tilesY;
+
+    // Per-tile particle lists (tileStart[t]..tileStart[t + 1] in tileParticles)
+    std::vector<std::uint32_t> tileStart;
+    std::vector<std::uint32_t> tileParticles;
+    std::vector<std::uint32_t> binCounts;
+
+    // Point sprite diameter in pixels (matches gl_PointSize)
+    float pointSize;
+
+    // Frame output
+    FrameOutput output;
+    std::string outputPattern;
+    int frameNumber;
+
+    ThreadPool pool;
+};
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include "ThreadPool.h"
+
+// Static dependency graph of tasks executed on a ThreadPool.
+//
+// The graph is built once and can be run any number of times. A task
+// starts as soon as all of its predecessors have finished; there are no
+// phase-wide barriers. When a task completes, the worker continues
+// directly with one of the successors it released, so dependent work on
+// the same data tends to stay on the same core.
+class TaskGraph {
+public:
+    TaskGraph();
+
+    // Remove all tasks
+    void clear();
+
+    // Add a task and return its id
+    int addTask(std::function<void()> task);
+
+    // Require task 'before' to finish before task 'after' starts
+    void addDependency(int before, int after);
+
+    // Run every task once and wait for the whole graph to finish
+    void run(ThreadPool& pool);
+
+    size_t getTaskCount() const { return tasks.size(); }
+
+private:
+    struct Task {
+        std::function<void()> function;
+        std::vector<int> successors;
+        int dependencyCount = 0;
+    };
+
+    // Worker loop executed on every pool thread
+    void worker();
+
+    // Mark a task finished and return the first successor it made ready (or -1)
+    int complete(int task);
+
+    std::vector<Task> tasks;
+
+    // Per-run state
+    std::unique_ptr<std::atomic<int>[]> remainingDependencies;
+    std::vector<int> readyTasks;
+    std::mutex readyMutex;
+    std::condition_variable readyCondition;
+    size_t completedTasks;
+};
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed set of worker threads that run a job on every thread at once.
+//
+// run() executes the job on all workers plus the calling thread and
+// returns when every copy has finished. parallelFor() builds on it and
+// hands out loop indices dynamically so uneven work balances itself.
+class ThreadPool {
+public:
+    // threadCount <= 0 uses the number of hardware threads
+    explicit ThreadPool(int threadCount = 0);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    // Total number of threads taking part in a job (workers + caller)
+    int getThreadCount() const { return static_cast<int>(workers.size()) + 1; }
+
+    // Resize the pool; must not be called while a job is running
+    void setThreadCount(int threadCount);
+
+    // Run job(threadIndex) on every thread and wait for all of them
+    void run(const std::function<void(int)>& job);
+
+    // Call body(i) for every i in [0, count), spread over the pool
+    void parallelFor(size_t count, const std::function<void(size_t)>& body);
+
+    // Number of hardware threads, at least 1
+    static int hardwareThreads();
+
+private:
+    void startWorkers(int workerCount);
+    void stopWorkers();
+    void workerLoop(int threadIndex, unsigned long long seenGeneration);
+
+    std::vector<std::thread> workers;
+
+    // Job dispatch state
+    std::mutex mutex;
+    std::condition_variable jobAvailable;
+    std::condition_variable jobFinished;
+    const std::function<void(int)>* job;
+    unsigned long long generation;
+    int pendingWorkers;
+    bool stopping;
+};
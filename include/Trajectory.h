@@ -0,0 +1,137 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "Particle.h"
+
+// Quantization steps used when encoding frames (absolute units per integer step)
+struct TrajectoryQuantization {
+    float position = 1.0e-3f;       // Position resolution
+    float velocity = 1.0e-3f;       // Velocity resolution
+    float density = 1.0e-2f;        // Density resolution
+    float pressure = 1.0f;          // Pressure resolution
+    float mass = 1.0e-4f;           // Mass resolution
+};
+
+// Index entry for one recorded frame
+struct TrajectoryFrameInfo {
+    std::uint64_t offset;           // Byte offset of the frame record in the file
+    std::uint32_t size;             // Size of the frame record in bytes
+    std::uint32_t particleCount;    // Number of particles in the frame
+    std::int64_t step;              // Simulation step the frame was taken at
+    bool keyframe;                  // Frame decodes without a previous frame
+};
+
+// Records particle snapshots to a compressed trajectory file.
+//
+// record() copies the particle state into a bounded queue and returns
+// immediately; a background thread quantizes each frame, delta-codes it
+// against the previous frame, entropy-codes it and appends it to the file.
+// Frames are grouped into chunks that start with a keyframe, and an index
+// written on close() allows random access through TrajectoryReader. If the
+// queue is full the snapshot is dropped rather than stalling the solver.
+class TrajectoryRecorder {
+public:
+    TrajectoryRecorder();
+    ~TrajectoryRecorder();
+
+    // Open the output file and start the writer thread
+    bool open(const std::string& path, int recordInterval = 1, int keyframeInterval = 32,
+              size_t queueCapacity = 8, const TrajectoryQuantization& quantization = TrajectoryQuantization());
+
+    // Flush pending frames, write the index and stop the writer thread
+    void close();
+
+    // Snapshot the particles if the step falls on the record interval
+    void record(std::int64_t step, const std::vector<Particle>& particles);
+
+    bool isOpen() const { return running; }
+
+    // Statistics
+    std::uint64_t getRecordedFrames() const;
+    std::uint64_t getDroppedFrames() const;
+    std::uint64_t getBytesWritten() const;
+
+private:
+    struct Snapshot {
+        std::int64_t step;
+        std::vector<Particle> particles;
+    };
+
+    // Writer thread entry point
+    void writerLoop();
+
+    // Encode one snapshot and append it to the file
+    void writeFrame(const Snapshot& snapshot);
+
+    // Output file and index of written frames
+    std::ofstream file;
+    std::vector<TrajectoryFrameInfo> index;
+
+    // Recording configuration
+    int recordInterval;
+    int keyframeInterval;
+    size_t queueCapacity;
+    TrajectoryQuantization quantization;
+
+    // Bounded snapshot queue and recycled snapshot buffers
+    std::deque<Snapshot> queue;
+    std::vector<Snapshot> freeSnapshots;
+    mutable std::mutex queueMutex;
+    std::condition_variable queueCondition;
+    std::thread writerThread;
+    bool running;
+    bool stopRequested;
+
+    // Encoder state (owned by the writer thread)
+    std::vector<std::int32_t> previousFrame;
+    std::vector<std::int32_t> currentFrame;
+    std::vector<std::uint8_t> rawBuffer;
+    std::vector<std::uint8_t> encodedBuffer;
+
+    // Statistics (guarded by queueMutex)
+    std::uint64_t recordedFrames;
+    std::uint64_t droppedFrames;
+    std::uint64_t bytesWritten;
+};
+
+// Reads trajectory files written by TrajectoryRecorder with random frame access
+class TrajectoryReader {
+public:
+    TrajectoryReader();
+
+    // Open a trajectory file and load its index
+    bool open(const std::string& path);
+
+    // Number of frames in the file
+    size_t getFrameCount() const { return index.size(); }
+
+    // Index entry for a frame
+    const TrajectoryFrameInfo& getFrameInfo(size_t frame) const { return index[frame]; }
+
+    // Decode a frame into particles; sequential reads reuse the previous frame
+    bool readFrame(size_t frame, std::vector<Particle>& particles);
+
+    // Quantization used by the recorder
+    const TrajectoryQuantization& getQuantization() const { return quantization; }
+
+private:
+    // Decode a frame record on top of the currently decoded frame
+    bool decodeFrame(size_t frame);
+
+    std::ifstream file;
+    std::vector<TrajectoryFrameInfo> index;
+    TrajectoryQuantization quantization;
+
+    // Decoder state
+    std::vector<std::int32_t> decodedFrame;
+    long long decodedFrameIndex;
+    std::vector<std::uint8_t> recordBuffer;
+    std::vector<std::uint8_t> rawBuffer;
+};
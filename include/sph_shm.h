@@ -0,0 +1,150 @@
+/*
+ * Shared-memory frame export: segment layout and C reader API.
+ *
+ * The simulation publishes every frame into a POSIX shared-memory ring of
+ * slots. Each slot is guarded by a sequence counter (a seqlock): it is odd
+ * while the producer writes the slot and even once the frame is complete.
+ * Readers map the segment read-only and access particle data in place.
+ * The producer never waits for readers, so a reader that holds a frame for
+ * too long can see its slot overwritten; sph_shm_validate() tells whether
+ * the data read since sph_shm_latest()/sph_shm_acquire() is still intact.
+ *
+ * Typical reader loop:
+ *
+ *     sph_shm_reader* reader = sph_shm_attach("/sph_frames");
+ *     sph_shm_frame frame;
+ *     if (sph_shm_latest(reader, &frame) == SPH_SHM_OK) {
+ *         for (uint32_t i = 0; i < frame.particle_count; ++i) {
+ *             const float* p = sph_shm_position(&frame, i);
+ *             ...
+ *         }
+ *         if (!sph_shm_validate(reader, &frame)) { discard results }
+ *     }
+ *     sph_shm_detach(reader);
+ */
+#ifndef SPH_SHM_H
+#define SPH_SHM_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define SPH_SHM_MAGIC 0x314D485348505340ULL  /* "@SPHSHM1" */
+#define SPH_SHM_VERSION 1u
+#define SPH_SHM_ALIGNMENT 64u
+
+/* Return codes */
+#define SPH_SHM_OK 0            /* Frame acquired */
+#define SPH_SHM_NO_FRAME 1      /* Nothing published yet, or the frame left the ring */
+#define SPH_SHM_RETRY 2         /* Slot is being rewritten; try again */
+#define SPH_SHM_CLOSED 3        /* Producer abandoned the segment; detach and attach again */
+#define SPH_SHM_ERROR (-1)      /* Invalid arguments */
+
+/* Byte offsets of particle fields within a particle record (all float32) */
+typedef struct sph_shm_layout {
+    uint32_t stride;            /* Bytes per particle record */
+    uint32_t position_offset;   /* x, y */
+    uint32_t velocity_offset;   /* x, y */
+    uint32_t force_offset;      /* x, y */
+    uint32_t mass_offset;
+    uint32_t density_offset;
+    uint32_t pressure_offset;
+    uint32_t reserved;
+} sph_shm_layout;
+
+/* Simulation parameters at the time a frame was published */
+typedef struct sph_shm_params {
+    float width;
+    float height;
+    float gravity_x;
+    float gravity_y;
+    float viscosity;
+    float gas_constant;
+    float rest_density;
+    float smoothing_radius;
+    float damping_coefficient;
+    float reserved[7];
+} sph_shm_params;
+
+/* Segment header at offset 0 */
+typedef struct sph_shm_header {
+    uint64_t magic;             /* SPH_SHM_MAGIC once the segment is initialized */
+    uint32_t version;           /* SPH_SHM_VERSION */
+    uint32_t slot_count;        /* Frames kept in the ring */
+    uint64_t slot_size;         /* Bytes per slot, including sph_shm_slot */
+    uint64_t data_offset;       /* Offset of slot 0 from the start of the segment */
+    uint32_t max_particles;     /* Particle capacity of a slot */
+    uint32_t closed;            /* Nonzero once the producer has left the segment */
+    uint32_t owner_pid;         /* Process id of the producer */
+    uint32_t reserved;
+    sph_shm_layout layout;
+    uint64_t latest_frame;      /* Newest complete frame id + 1, or 0 if none */
+} sph_shm_header;
+
+/* Slot header; particle records follow at SPH_SHM_SLOT_HEADER_SIZE */
+typedef struct sph_shm_slot {
+    uint64_t sequence;          /* 2 * frame_id + 1 while writing, 2 * frame_id + 2 when complete */
+    uint64_t frame_id;
+    uint32_t particle_count;
+    uint32_t reserved;
+    sph_shm_params params;
+} sph_shm_slot;
+
+#define SPH_SHM_SLOT_HEADER_SIZE \
+    ((sizeof(sph_shm_slot) + SPH_SHM_ALIGNMENT - 1) / SPH_SHM_ALIGNMENT * SPH_SHM_ALIGNMENT)
+
+/* A frame acquired by a reader; particles points into shared memory */
+typedef struct sph_shm_frame {
+    uint64_t frame_id;
+    uint32_t particle_count;
+    sph_shm_params params;
+    sph_shm_layout layout;
+    const unsigned char* particles;
+    uint64_t sequence;          /* Slot sequence at acquisition (used by sph_shm_validate) */
+    const sph_shm_slot* slot;
+} sph_shm_frame;
+
+typedef struct sph_shm_reader sph_shm_reader;
+
+/* Map the named segment read-only; NULL if it does not exist or is invalid */
+sph_shm_reader* sph_shm_attach(const char* name);
+
+/* Unmap the segment */
+void sph_shm_detach(sph_shm_reader* reader);
+
+/* Segment header (read-only) */
+const sph_shm_header* sph_shm_get_header(const sph_shm_reader* reader);
+
+/* Acquire the newest complete frame */
+int sph_shm_latest(sph_shm_reader* reader, sph_shm_frame* frame);
+
+/* Acquire a specific frame if it is still in the ring */
+int sph_shm_acquire(sph_shm_reader* reader, uint64_t frame_id, sph_shm_frame* frame);
+
+/* 1 if the frame's slot was not overwritten since it was acquired, 0 otherwise */
+int sph_shm_validate(const sph_shm_reader* reader, const sph_shm_frame* frame);
+
+/* Field access helpers */
+static inline const float* sph_shm_position(const sph_shm_frame* frame, uint32_t i) {
+    return (const float*)(frame->particles + (uint64_t)i * frame->layout.stride + frame->layout.position_offset);
+}
+
+static inline const float* sph_shm_velocity(const sph_shm_frame* frame, uint32_t i) {
+    return (const float*)(frame->particles + (uint64_t)i * frame->layout.stride + frame->layout.velocity_offset);
+}
+
+static inline float sph_shm_density(const sph_shm_frame* frame, uint32_t i) {
+    return *(const float*)(frame->particles + (uint64_t)i * frame->layout.stride + frame->layout.density_offset);
+}
+
+static inline float sph_shm_pressure(const sph_shm_frame* frame, uint32_t i) {
+    return *(const float*)(frame->particles + (uint64_t)i * frame->layout.stride + frame->layout.pressure_offset);
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SPH_SHM_H */
@@ -0,0 +1,214 @@
+#include "AutoTuner.h"
+#include "Cache.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <thread>
+
+namespace {
+    // Steps run before timing so the scene is past its initial transient
+    constexpr int WARMUP_STEPS = 10;
+
+    // Candidate values for each setting
+    const int TILE_SIZES[] = {1, 2, 4, 8, 16};
+    const float CELL_SIZE_SCALES[] = {1.0f, 1.25f, 1.5f, 2.0f};
+    const int REORDER_INTERVALS[] = {0, 1, 4, 16};
+
+    // CPU model and thread count identify the machine
+    std::string machineDescription() {
+        std::string model;
+        std::ifstream cpuinfo("/proc/cpuinfo");
+        std::string line;
+        while (std::getline(cpuinfo, line)) {
+            if (line.compare(0, 10, "model name") == 0) {
+                model = line.substr(line.find(':') + 1);
+                break;
+            }
+        }
+        return model + "/" + std::to_string(std::thread::hardware_concurrency());
+    }
+
+    std::vector<int> threadCandidates() {
+        int hardware = ThreadPool::hardwareThreads();
+        std::vector<int> candidates;
+        for (int threads = 1; threads < hardware; threads *= 2) candidates.push_back(threads);
+        candidates.push_back(hardware);
+        return candidates;
+    }
+}
+
+AutoTuner::AutoTuner(const std::string& cachePath)
+    : cachePath(cachePath), calibrationSteps(8), tuneThreads(true), tuneReorder(false) {
+    if (this->cachePath.empty()) {
+        std::string directory = Cache::directory();
+        if (!directory.empty()) this->cachePath = directory + "/autotune.txt";
+    }
+}
+
+bool AutoTuner::applyCached(Simulation& simulation) {
+    TuningConfig config;
+    if (!loadCached(cacheKey(simulation), config)) return false;
+    keepFixedSettings(simulation, config);
+    apply(simulation, config);
+    return true;
+}
+
+TuningConfig AutoTuner::tune(Simulation& simulation, float dt, bool force) {
+    std::string key = cacheKey(simulation);
+
+    TuningConfig best;
+    if (!force && loadCached(key, best)) {
+        keepFixedSettings(simulation, best);
+        apply(simulation, best);
+        return best;
+    }
+
+    // Scratch copy of the scene so the live simulation is untouched
+    Simulation scratch(simulation.getWidth(), simulation.getHeight());
+    scratch.setGravity(simulation.getGravity());
+    scratch.setViscosity(simulation.getViscosity());
+    scratch.setGasConstant(simulation.getGasConstant());
+    scratch.setRestDensity(simulation.getRestDensity());
+    scratch.setSmoothingRadius(simulation.getSmoothingRadius());
+    scratch.setDampingCoefficient(simulation.getDampingCoefficient());
+    scratch.setRenderPacking(simulation.getRenderPacking());
+    scratch.setParticles(simulation.getParticles());
+    for (int i = 0; i < WARMUP_STEPS; ++i) scratch.update(dt);
+    std::vector<Particle> start = scratch.getParticles();
+
+    // Start from the simulation's current settings
+    best.threadCount = simulation.getThreadCount();
+    best.tileSize = simulation.getTileSize();
+    best.cellSizeScale = simulation.getCellSizeScale();
+    best.reorderInterval = simulation.getReorderInterval();
+    double bestTime = measure(scratch, start, best, dt, calibrationSteps);
+
+    // Tune one setting at a time, keeping the fastest value
+    auto tryConfig = [&](const TuningConfig& candidate, int steps) {
+        double time = measure(scratch, start, candidate, dt, steps);
+        if (time < bestTime) {
+            bestTime = time;
+            best = candidate;
+        }
+    };
+
+    if (tuneThreads) {
+        for (int threads : threadCandidates()) {
+            TuningConfig candidate = best;
+            candidate.threadCount = threads;
+            tryConfig(candidate, calibrationSteps);
+        }
+    }
+    for (float scale : CELL_SIZE_SCALES) {
+        TuningConfig candidate = best;
+        candidate.cellSizeScale = scale;
+        tryConfig(candidate, calibrationSteps);
+    }
+    for (int tile : TILE_SIZES) {
+        TuningConfig candidate = best;
+        candidate.tileSize = tile;
+        tryConfig(candidate, calibrationSteps);
+    }
+    if (tuneReorder) {
+        for (int interval : REORDER_INTERVALS) {
+            // Time at least one full interval so the reorder cost is included
+            TuningConfig candidate = best;
+            candidate.reorderInterval = interval;
+            tryConfig(candidate, std::max(calibrationSteps, interval));
+        }
+    }
+
+    std::cerr << "Auto-tune: " << best.threadCount << " threads, tile " << best.tileSize
+              << ", cell scale " << best.cellSizeScale << ", reorder " << best.reorderInterval
+              << " (" << bestTime * 1000.0 << " ms/step)" << std::endl;
+
+    apply(simulation, best);
+    storeCached(key, best);
+    return best;
+}
+
+void AutoTuner::apply(Simulation& simulation, const TuningConfig& config) {
+    simulation.setThreadCount(config.threadCount);
+    simulation.setTileSize(config.tileSize);
+    simulation.setCellSizeScale(config.cellSizeScale);
+    simulation.setReorderInterval(config.reorderInterval);
+}
+
+std::string AutoTuner::signature(const Simulation& simulation) {
+    char scene[128];
+    std::snprintf(scene, sizeof(scene), "%zu-%gx%g-h%g", simulation.getParticles().size(),
+                  simulation.getWidth(), simulation.getHeight(), simulation.getSmoothingRadius());
+    return Cache::toHex(Cache::hash(machineDescription())) + "-" + scene;
+}
+
+std::string AutoTuner::cacheKey(const Simulation& simulation) const {
+    // Results depend on which settings were held fixed
+    std::string key = signature(simulation);
+    if (!tuneThreads) key += "-t" + std::to_string(simulation.getThreadCount());
+    if (tuneReorder) key += "-reorder";
+    return key;
+}
+
+void AutoTuner::keepFixedSettings(const Simulation& simulation, TuningConfig& config) const {
+    if (!tuneThreads) config.threadCount = simulation.getThreadCount();
+    if (!tuneReorder) config.reorderInterval = simulation.getReorderInterval();
+}
+
+double AutoTuner::measure(Simulation& scratch, const std::vector<Particle>& start,
+                          const TuningConfig& config, float dt, int steps) {
+    apply(scratch, config);
+    scratch.setParticles(start);
+
+    // First step rebuilds the grid and task graph; keep it out of the timing
+    scratch.update(dt);
+
+    auto begin = std::chrono::steady_clock::now();
+    for (int i = 0; i < steps; ++i) scratch.update(dt);
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double>(end - begin).count() / steps;
+}
+
+bool AutoTuner::loadCached(const std::string& key, TuningConfig& config) const {
+    if (cachePath.empty()) return false;
+
+    // One line per entry: key threads tileSize cellSizeScale reorderInterval
+    std::ifstream file(cachePath);
+    std::string line;
+    while (std::getline(file, line)) {
+        std::istringstream entry(line);
+        std::string entryKey;
+        TuningConfig entryConfig;
+        if (entry >> entryKey >> entryConfig.threadCount >> entryConfig.tileSize >>
+                     entryConfig.cellSizeScale >> entryConfig.reorderInterval && entryKey == key) {
+            config = entryConfig;
+            return true;
+        }
+    }
+    return false;
+}
+
+void AutoTuner::storeCached(const std::string& key, const TuningConfig& config) const {
+    if (cachePath.empty()) return;
+
+    // Keep other entries, replace this one
+    std::vector<std::string> lines;
+    {
+        std::ifstream file(cachePath);
+        std::string line;
+        while (std::getline(file, line)) {
+            if (line.compare(0, key.size() + 1, key + " ") != 0) lines.push_back(line);
+        }
+    }
+
+    std::ostringstream entry;
+    entry << key << " " << config.threadCount << " " << config.tileSize << " "
+          << config.cellSizeScale << " " << config.reorderInterval;
+    lines.push_back(entry.str());
+
+    std::string contents;
+    for (const auto& line : lines) contents += line + "\n";
+    Cache::writeFileAtomically(cachePath, contents.data(), contents.size());
+}
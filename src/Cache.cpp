@@ -0,0 +1,103 @@
+#include "Cache.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <system_error>
+#include <utility>
+#include <vector>
+#include <unistd.h>
+
+namespace Cache {
+    std::string directory() {
+        std::filesystem::path path;
+        if (const char* dir = std::getenv("SPH_CACHE_DIR")) {
+            path = dir;
+        } else if (const char* xdg = std::getenv("XDG_CACHE_HOME")) {
+            path = std::filesystem::path(xdg) / "sph-fluid-simulation";
+        } else if (const char* home = std::getenv("HOME")) {
+            path = std::filesystem::path(home) / ".cache" / "sph-fluid-simulation";
+        } else {
+            return std::string();
+        }
+
+        std::error_code error;
+        std::filesystem::create_directories(path, error);
+        if (error) {
+            std::cerr << "Failed to create cache directory " << path << ": " << error.message() << std::endl;
+            return std::string();
+        }
+        return path.string();
+    }
+
+    std::uint64_t hash(const void* data, size_t size, std::uint64_t seed) {
+        const unsigned char* bytes = static_cast<const unsigned char*>(data);
+        std::uint64_t h = seed;
+        for (size_t i = 0; i < size; ++i) {
+            h ^= bytes[i];
+            h *= 1099511628211ull;
+        }
+        return h;
+    }
+
+    std::uint64_t hash(const std::string& text, std::uint64_t seed) {
+        return hash(text.data(), text.size(), seed);
+    }
+
+    std::string toHex(std::uint64_t value) {
+        char buffer[17];
+        std::snprintf(buffer, sizeof(buffer), "%016llx", static_cast<unsigned long long>(value));
+        return buffer;
+    }
+
+    bool writeFileAtomically(const std::string& path, const void* data, size_t size) {
+        // Process id and a per-process counter keep temporary names unique
+        static std::atomic<unsigned int> counter(0);
+        std::string temporaryPath = path + ".tmp." + std::to_string(getpid()) + "." + std::to_string(counter++);
+
+        {
+            std::ofstream file(temporaryPath, std::ios::binary | std::ios::trunc);
+            file.write(static_cast<const char*>(data), static_cast<std::streamsize>(size));
+            if (!file) {
+                std::cerr << "Failed to write cache file: " << temporaryPath << std::endl;
+                std::remove(temporaryPath.c_str());
+                return false;
+            }
+        }
+        if (std::rename(temporaryPath.c_str(), path.c_str()) != 0) {
+            std::cerr << "Failed to update cache file: " << path << std::endl;
+            std::remove(temporaryPath.c_str());
+            return false;
+        }
+        return true;
+    }
+
+    void touch(const std::string& path) {
+        std::error_code error;
+        std::filesystem::last_write_time(path, std::filesystem::file_time_type::clock::now(), error);
+    }
+
+    void prune(const std::string& directory, const std::string& prefix, const std::string& suffix, size_t keep) {
+        std::error_code error;
+        std::vector<std::pair<std::filesystem::file_time_type, std::filesystem::path>> files;
+        for (const auto& entry : std::filesystem::directory_iterator(directory, error)) {
+            std::string name = entry.path().filename().string();
+            if (name.size() < prefix.size() + suffix.size() || name.compare(0, prefix.size(), prefix) != 0 ||
+                name.compare(name.size() - suffix.size(), suffix.size(), suffix) != 0) {
+                continue;
+            }
+            auto time = entry.last_write_time(error);
+            if (!error) files.emplace_back(time, entry.path());
+        }
+        if (files.size() <= keep) return;
+
+        // Newest first; another process may delete the same files concurrently
+        std::sort(files.begin(), files.end(), [](const auto& a, const auto& b) { return a.first > b.first; });
+        for (size_t i = keep; i < files.size(); ++i) {
+            std::filesystem::remove(files[i].second, error);
+        }
+    }
+}
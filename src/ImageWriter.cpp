@@ -0,0 +1,248 @@
+#include "ImageWriter.h"
+#include "ThreadPool.h"
+#include <algorithm>
+#include <array>
+#include <cstdio>
+#include <iostream>
+
+namespace {
+    // Deflate length codes 257..285
+    const std::uint16_t LENGTH_BASE[29] = {3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+                                           35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258};
+    const std::uint8_t LENGTH_EXTRA[29] = {0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+                                           3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0};
+
+    // Deflate distance codes 0..29
+    const std::uint16_t DISTANCE_BASE[30] = {1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193,
+                                             257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145,
+                                             8193, 12289, 16385, 24577};
+    const std::uint8_t DISTANCE_EXTRA[30] = {0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6,
+                                             7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13};
+
+    constexpr size_t MAX_MATCH = 258;
+    constexpr size_t MAX_DISTANCE = 32768;
+
+    // LSB-first bit writer for deflate streams
+    class BitWriter {
+    public:
+        explicit BitWriter(std::vector<std::uint8_t>& out) : out(out), buffer(0), count(0) {}
+
+        void put(std::uint32_t bits, int n) {
+            buffer |= static_cast<std::uint64_t>(bits) << count;
+            count += n;
+            while (count >= 8) {
+                out.push_back(static_cast<std::uint8_t>(buffer));
+                buffer >>= 8;
+                count -= 8;
+            }
+        }
+
+        // Huffman codes are stored most significant bit first
+        void putCode(std::uint32_t code, int n) {
+            std::uint32_t reversed = 0;
+            for (int i = 0; i < n; ++i) reversed |= ((code >> i) & 1u) << (n - 1 - i);
+            put(reversed, n);
+        }
+
+        void align() {
+            if (count > 0) put(0, 8 - count);
+        }
+
+    private:
+        std::vector<std::uint8_t>& out;
+        std::uint64_t buffer;
+        int count;
+    };
+
+    // Fixed Huffman literal/length code
+    void putLiteral(BitWriter& bits, int symbol) {
+        if (symbol < 144) bits.putCode(0x30 + symbol, 8);
+        else if (symbol < 256) bits.putCode(0x190 + symbol - 144, 9);
+        else if (symbol < 280) bits.putCode(symbol - 256, 7);
+        else bits.putCode(0xC0 + symbol - 280, 8);
+    }
+
+    void putMatch(BitWriter& bits, size_t length, size_t distance) {
+        int lengthCode = 28;
+        while (LENGTH_BASE[lengthCode] > length) --lengthCode;
+        putLiteral(bits, 257 + lengthCode);
+        bits.put(static_cast<std::uint32_t>(length - LENGTH_BASE[lengthCode]), LENGTH_EXTRA[lengthCode]);
+
+        int distanceCode = 29;
+        while (DISTANCE_BASE[distanceCode] > distance) --distanceCode;
+        bits.putCode(distanceCode, 5);
+        bits.put(static_cast<std::uint32_t>(distance - DISTANCE_BASE[distanceCode]), DISTANCE_EXTRA[distanceCode]);
+    }
+
+    // Compress data[begin, end) as one fixed-Huffman block. Matches only look
+    // back to the previous pixel and the previous row, which is where nearly
+    // all redundancy in a particle frame is, and never cross the band start
+    // so bands can be compressed independently and concatenated.
+    void deflateBand(const std::uint8_t* data, size_t begin, size_t end, size_t rowStride,
+                     bool final, std::vector<std::uint8_t>& out) {
+        BitWriter bits(out);
+        bits.put(final ? 1 : 0, 1);
+        bits.put(1, 2);
+
+        const size_t distances[2] = {3, rowStride};
+        size_t i = begin;
+        while (i < end) {
+            size_t bestLength = 0;
+            size_t bestDistance = 0;
+            for (size_t distance : distances) {
+                if (distance > MAX_DISTANCE || i - begin < distance) continue;
+                size_t limit = std::min(MAX_MATCH, end - i);
+                size_t length = 0;
+                while (length < limit && data[i + length] == data[i + length - distance]) ++length;
+                if (length > bestLength) {
+                    bestLength = length;
+                    bestDistance = distance;
+                }
+            }
+
+            if (bestLength >= 3) {
+                putMatch(bits, bestLength, bestDistance);
+                i += bestLength;
+            } else {
+                putLiteral(bits, data[i]);
+                ++i;
+            }
+        }
+        putLiteral(bits, 256);
+
+        // Non-final bands end with an empty stored block to reach a byte boundary
+        if (!final) {
+            bits.put(0, 3);
+            bits.align();
+            out.push_back(0x00);
+            out.push_back(0x00);
+            out.push_back(0xFF);
+            out.push_back(0xFF);
+        } else {
+            bits.align();
+        }
+    }
+
+    std::uint32_t adler32(const std::uint8_t* data, size_t size) {
+        std::uint32_t a = 1, b = 0;
+        while (size > 0) {
+            size_t block = std::min<size_t>(size, 5552);
+            for (size_t i = 0; i < block; ++i) {
+                a += data[i];
+                b += a;
+            }
+            a %= 65521;
+            b %= 65521;
+            data += block;
+            size -= block;
+        }
+        return (b << 16) | a;
+    }
+
+    std::uint32_t crc32(const std::uint8_t* data, size_t size, std::uint32_t crc = 0) {
+        static const std::array<std::uint32_t, 256> table = [] {
+            std::array<std::uint32_t, 256> t{};
+            for (std::uint32_t n = 0; n < 256; ++n) {
+                std::uint32_t c = n;
+                for (int k = 0; k < 8; ++k) c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+                t[n] = c;
+            }
+            return t;
+        }();
+
+        crc = ~crc;
+        for (size_t i = 0; i < size; ++i) crc = table[(crc ^ data[i]) & 0xff] ^ (crc >> 8);
+        return ~crc;
+    }
+
+    void putBigEndian32(std::vector<std::uint8_t>& out, std::uint32_t v) {
+        out.push_back(static_cast<std::uint8_t>(v >> 24));
+        out.push_back(static_cast<std::uint8_t>(v >> 16));
+        out.push_back(static_cast<std::uint8_t>(v >> 8));
+        out.push_back(static_cast<std::uint8_t>(v));
+    }
+
+    void putChunk(std::vector<std::uint8_t>& out, const char* type, const std::uint8_t* data, size_t size) {
+        putBigEndian32(out, static_cast<std::uint32_t>(size));
+        size_t typeStart = out.size();
+        out.insert(out.end(), type, type + 4);
+        out.insert(out.end(), data, data + size);
+        putBigEndian32(out, crc32(out.data() + typeStart, size + 4));
+    }
+
+    bool writeFile(const std::string& path, const std::uint8_t* data, size_t size) {
+        FILE* file = std::fopen(path.c_str(), "wb");
+        if (!file) {
+            std::cerr << "Failed to open image file: " << path << std::endl;
+            return false;
+        }
+        bool ok = std::fwrite(data, 1, size, file) == size;
+        ok = (std::fclose(file) == 0) && ok;
+        if (!ok) {
+            std::cerr << "Failed to write image file: " << path << std::endl;
+        }
+        return ok;
+    }
+}
+
+namespace ImageWriter {
+    bool writePPM(const std::string& path, int width, int height, const std::uint8_t* rgb) {
+        std::string header = "P6\n" + std::to_string(width) + " " + std::to_string(height) + "\n255\n";
+        std::vector<std::uint8_t> out(header.begin(), header.end());
+        out.insert(out.end(), rgb, rgb + static_cast<size_t>(width) * height * 3);
+        return writeFile(path, out.data(), out.size());
+    }
+
+    bool writePNG(const std::string& path, int width, int height, const std::uint8_t* rgb, ThreadPool* pool) {
+        std::vector<std::uint8_t> out;
+        encodePNG(width, height, rgb, out, pool);
+        return writeFile(path, out.data(), out.size());
+    }
+
+    void encodePNG(int width, int height, const std::uint8_t* rgb, std::vector<std::uint8_t>& out, ThreadPool* pool) {
+        // Scanlines with filter type 0 (None)
+        size_t rowBytes = static_cast<size_t>(width) * 3;
+        size_t rowStride = rowBytes + 1;
+        std::vector<std::uint8_t> scanlines(rowStride * height);
+        for (int y = 0; y < height; ++y) {
+            scanlines[y * rowStride] = 0;
+            std::copy(rgb + y * rowBytes, rgb + (y + 1) * rowBytes, scanlines.begin() + y * rowStride + 1);
+        }
+
+        // Compress horizontal bands independently, then concatenate
+        int bandCount = pool ? std::max(1, std::min(pool->getThreadCount(), height)) : 1;
+        std::vector<std::vector<std::uint8_t>> bands(bandCount);
+        auto compressBand = [&](size_t band) {
+            size_t firstRow = band * height / bandCount;
+            size_t lastRow = (band + 1) * height / bandCount;
+            deflateBand(scanlines.data(), firstRow * rowStride, lastRow * rowStride, rowStride,
+                        band + 1 == static_cast<size_t>(bandCount), bands[band]);
+        };
+        if (pool) {
+            pool->parallelFor(bandCount, compressBand);
+        } else {
+            compressBand(0);
+        }
+
+        // zlib stream: header, deflate data, Adler-32
+        std::vector<std::uint8_t> zlib = {0x78, 0x01};
+        for (const auto& band : bands) zlib.insert(zlib.end(), band.begin(), band.end());
+        putBigEndian32(zlib, adler32(scanlines.data(), scanlines.size()));
+
+        // PNG signature, IHDR, IDAT, IEND
+        static const std::uint8_t signature[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+        out.assign(signature, signature + 8);
+
+        std::vector<std::uint8_t> ihdr;
+        putBigEndian32(ihdr, static_cast<std::uint32_t>(width));
+        putBigEndian32(ihdr, static_cast<std::uint32_t>(height));
+        ihdr.push_back(8);  // Bit depth
+        ihdr.push_back(2);  // Color type RGB
+        ihdr.push_back(0);  // Compression
+        ihdr.push_back(0);  // Filter
+        ihdr.push_back(0);  // Interlace
+        putChunk(out, "IHDR", ihdr.data(), ihdr.size());
+        putChunk(out, "IDAT", zlib.data(), zlib.size());
+        putChunk(out, "IEND", nullptr, 0);
+    }
+}
@@ -0,0 +1,229 @@
+#include "InitialState.h"
+#include "Cache.h"
+#include "SPHKernels.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <random>
+
+namespace {
+    // Warm-start file header
+    const char CACHE_MAGIC[8] = {'S', 'P', 'H', 'I', 'N', 'I', 'T', '1'};
+
+    // Lattices denser than this many points per smoothing radius use the
+    // continuum estimate of the density instead of an explicit sum
+    constexpr int MAX_LATTICE_SUM_RADIUS = 64;
+
+    // Fraction of a square lattice's density reached by Poisson-disk sampling
+    constexpr float POISSON_PACKING = 0.65f;
+
+    // Poly6 density of an infinite square lattice at the given spacing
+    float latticeDensity(float mass, float spacing, float h) {
+        int n = static_cast<int>(h / spacing);
+        if (n > MAX_LATTICE_SUM_RADIUS) {
+            // Integral of the kernel over the plane, divided by the area per particle
+            constexpr int STEPS = 1024;
+            float integral = 0.0f;
+            for (int i = 0; i < STEPS; ++i) {
+                float r = (i + 0.5f) * h / STEPS;
+                integral += SPHKernels::Poly6::W(glm::vec2(r, 0.0f), h) * 2.0f * SPHKernels::PI * r * (h / STEPS);
+            }
+            return mass * integral / (spacing * spacing);
+        }
+
+        float density = 0.0f;
+        for (int j = -n; j <= n; ++j) {
+            for (int i = -n; i <= n; ++i) {
+                density += mass * SPHKernels::Poly6::W(glm::vec2(i * spacing, j * spacing), h);
+            }
+        }
+        return density;
+    }
+
+    // Block of the given size with the region's placement rules
+    glm::vec2 blockOrigin(const glm::vec2& size, const glm::vec2& regionMin, const glm::vec2& regionMax,
+                          const glm::vec2& domain) {
+        float centerX = 0.5f * (regionMin.x + regionMax.x);
+        float x = std::clamp(centerX - 0.5f * size.x, 0.0f, std::max(0.0f, domain.x - size.x));
+        float y = std::clamp(regionMin.y, 0.0f, std::max(0.0f, domain.y - size.y));
+        return glm::vec2(x, y);
+    }
+
+    // Block of the given area with the aspect ratio of the region, fitted to the domain
+    glm::vec2 blockSize(float area, const glm::vec2& regionMin, const glm::vec2& regionMax, const glm::vec2& domain) {
+        float aspect = (regionMax.x - regionMin.x) / std::max(regionMax.y - regionMin.y, 1e-6f);
+        float w = std::min(std::sqrt(area * aspect), domain.x);
+        float h = std::min(area / std::max(w, 1e-6f), domain.y);
+        return glm::vec2(w, h);
+    }
+}
+
+namespace InitialState {
+    float restSpacing(float mass, float restDensity, float smoothingRadius) {
+        float h = smoothingRadius;
+
+        // An isolated particle is already at or above rest density
+        if (latticeDensity(mass, h, h) >= restDensity) return h;
+
+        // Density falls monotonically with spacing; bisect on a log scale
+        float lo = h * 1e-6f;
+        float hi = h;
+        for (int i = 0; i < 60; ++i) {
+            float mid = std::sqrt(lo * hi);
+            if (latticeDensity(mass, mid, h) > restDensity) lo = mid;
+            else hi = mid;
+        }
+        return hi;
+    }
+
+    std::vector<glm::vec2> lattice(int count, const glm::vec2& regionMin, const glm::vec2& regionMax,
+                                   const glm::vec2& domain, float spacing) {
+        std::vector<glm::vec2> positions;
+        if (count <= 0) return positions;
+        positions.reserve(count);
+
+        // Columns and rows following the region's aspect ratio
+        float aspect = (regionMax.x - regionMin.x) / std::max(regionMax.y - regionMin.y, 1e-6f);
+        int cols = std::max(1, static_cast<int>(std::ceil(std::sqrt(count * aspect))));
+        cols = std::min(cols, std::max(1, static_cast<int>(domain.x / spacing)));
+        int rows = (count + cols - 1) / cols;
+
+        // Compress only if the block cannot fit in the domain at all
+        spacing = std::min({spacing, domain.x / cols, domain.y / rows});
+
+        glm::vec2 size(cols * spacing, rows * spacing);
+        glm::vec2 origin = blockOrigin(size, regionMin, regionMax, domain);
+
+        // Fill rows bottom-up, cells centered in the block
+        for (int i = 0; i < count; ++i) {
+            int row = i / cols;
+            int col = i % cols;
+            positions.emplace_back(origin.x + (col + 0.5f) * spacing, origin.y + (row + 0.5f) * spacing);
+        }
+        return positions;
+    }
+
+    std::vector<glm::vec2> poissonDisk(int count, const glm::vec2& regionMin, const glm::vec2& regionMax,
+                                       const glm::vec2& domain, float spacing, unsigned int seed) {
+        std::vector<glm::vec2> samples;
+        if (count <= 0) return samples;
+
+        std::mt19937 gen(seed);
+        std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+        constexpr int ATTEMPTS = 30;
+
+        // Grow the block until it holds enough samples
+        float area = count * spacing * spacing / POISSON_PACKING;
+        glm::vec2 size(0.0f);
+        for (int tries = 0; tries < 8 && static_cast<int>(samples.size()) < count; ++tries, area *= 1.2f) {
+            size = blockSize(area, regionMin, regionMax, domain);
+            samples.clear();
+
+            // Background grid with at most one sample per cell
+            float cell = spacing / std::sqrt(2.0f);
+            int gridW = std::max(1, static_cast<int>(std::ceil(size.x / cell)));
+            int gridH = std::max(1, static_cast<int>(std::ceil(size.y / cell)));
+            std::vector<int> grid(static_cast<size_t>(gridW) * gridH, -1);
+            auto gridIndex = [&](const glm::vec2& p) {
+                int gx = std::min(static_cast<int>(p.x / cell), gridW - 1);
+                int gy = std::min(static_cast<int>(p.y / cell), gridH - 1);
+                return gy * gridW + gx;
+            };
+            auto farEnough = [&](const glm::vec2& p) {
+                int gx = std::min(static_cast<int>(p.x / cell), gridW - 1);
+                int gy = std::min(static_cast<int>(p.y / cell), gridH - 1);
+                for (int y = std::max(gy - 2, 0); y <= std::min(gy + 2, gridH - 1); ++y) {
+                    for (int x = std::max(gx - 2, 0); x <= std::min(gx + 2, gridW - 1); ++x) {
+                        int s = grid[y * gridW + x];
+                        if (s >= 0) {
+                            glm::vec2 d = samples[s] - p;
+                            if (glm::dot(d, d) < spacing * spacing) return false;
+                        }
+                    }
+                }
+                return true;
+            };
+
+            glm::vec2 first(unit(gen) * size.x, unit(gen) * size.y);
+            samples.push_back(first);
+            grid[gridIndex(first)] = 0;
+            std::vector<int> active = {0};
+
+            while (!active.empty() && static_cast<int>(samples.size()) < count) {
+                size_t pick = static_cast<size_t>(unit(gen) * active.size()) % active.size();
+                glm::vec2 center = samples[active[pick]];
+                bool found = false;
+
+                // Candidates in the annulus [spacing, 2 * spacing)
+                for (int k = 0; k < ATTEMPTS; ++k) {
+                    float angle = 2.0f * SPHKernels::PI * unit(gen);
+                    float radius = spacing * (1.0f + unit(gen));
+                    glm::vec2 candidate = center + radius * glm::vec2(std::cos(angle), std::sin(angle));
+                    if (candidate.x < 0.0f || candidate.y < 0.0f || candidate.x >= size.x || candidate.y >= size.y) continue;
+                    if (!farEnough(candidate)) continue;
+
+                    grid[gridIndex(candidate)] = static_cast<int>(samples.size());
+                    active.push_back(static_cast<int>(samples.size()));
+                    samples.push_back(candidate);
+                    found = true;
+                    break;
+                }
+
+                if (!found) {
+                    active[pick] = active.back();
+                    active.pop_back();
+                }
+            }
+        }
+
+        // The block hit the domain limits; fill the rest randomly
+        while (static_cast<int>(samples.size()) < count) {
+            samples.emplace_back(unit(gen) * size.x, unit(gen) * size.y);
+        }
+
+        glm::vec2 origin = blockOrigin(size, regionMin, regionMax, domain);
+        for (auto& p : samples) p += origin;
+        return samples;
+    }
+
+    bool load(const std::string& path, size_t count, std::vector<glm::vec2>& positions) {
+        std::ifstream file(path, std::ios::binary);
+        if (!file) return false;
+
+        char magic[8];
+        std::uint64_t storedCount = 0;
+        if (!file.read(magic, sizeof(magic)) || std::memcmp(magic, CACHE_MAGIC, 8) != 0 ||
+            !file.read(reinterpret_cast<char*>(&storedCount), sizeof(storedCount)) || storedCount != count) {
+            return false;
+        }
+
+        std::vector<float> data(count * 2);
+        if (!file.read(reinterpret_cast<char*>(data.data()), data.size() * sizeof(float))) return false;
+
+        positions.resize(count);
+        for (size_t i = 0; i < count; ++i) {
+            positions[i] = glm::vec2(data[2 * i], data[2 * i + 1]);
+        }
+        return true;
+    }
+
+    bool store(const std::string& path, const std::vector<glm::vec2>& positions) {
+        // Header (magic, count) followed by x, y pairs
+        std::uint64_t count = positions.size();
+        std::vector<char> buffer(sizeof(CACHE_MAGIC) + sizeof(count) + count * 2 * sizeof(float));
+        char* out = buffer.data();
+        std::memcpy(out, CACHE_MAGIC, sizeof(CACHE_MAGIC));
+        out += sizeof(CACHE_MAGIC);
+        std::memcpy(out, &count, sizeof(count));
+        out += sizeof(count);
+        for (const auto& p : positions) {
+            float xy[2] = {p.x, p.y};
+            std::memcpy(out, xy, sizeof(xy));
+            out += sizeof(xy);
+        }
+
+        return Cache::writeFileAtomically(path, buffer.data(), buffer.size());
+    }
+}
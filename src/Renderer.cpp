@@ -1,6 +1,8 @@
 #include "Renderer.h"
+#include "ColorMap.h"
 #include <iostream>
 #include <vector>
+#include <algorithm>
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
 
@@ -122,18 +124,6 @@ bool Renderer::initialize() {
 }
 
 void Renderer::render(const std::vector<Particle>& particles) {
-    // Clear the screen
-    glClearColor(0.1f, 0.1f, 0.1f, 1.0f);
-    glClear(GL_COLOR_BUFFER_BIT);
-    
-    // Use shader program
-    glUseProgram(shaderProgram);
-    
-    // Set projection matrix (map simulation coordinates to screen coordinates)
-    glm::mat4 projection = glm::ortho(0.0f, static_cast<float>(width), 0.0f, static_cast<float>(height));
-    GLint projectionLoc = glGetUniformLocation(shaderProgram, "projection");
-    glUniformMatrix4fv(projectionLoc, 1, GL_FALSE, glm::value_ptr(projection));
-    
     // Prepare position data
     std::vector<glm::vec2> positions;
     positions.reserve(particles.size());
@@ -145,12 +135,25 @@ void Renderer::render(const std::vector<Particle>& particles) {
     std::vector<glm::vec3> colors;
     colors.reserve(particles.size());
     for (const auto& p : particles) {
-        // Map density to color (blue to cyan to white)
-        float normalizedDensity = std::min(p.density / 1500.0f, 1.0f);
-        glm::vec3 color(normalizedDensity, 0.5f + 0.5f * normalizedDensity, 1.0f);
-        colors.push_back(color);
+        colors.push_back(ColorMap::densityToColor(p.density));
     }
     
+    render(positions, colors);
+}
+
+void Renderer::render(const std::vector<glm::vec2>& positions, const std::vector<glm::vec3>& colors) {
+    // Clear the screen
+    glClearColor(0.1f, 0.1f, 0.1f, 1.0f);
+    glClear(GL_COLOR_BUFFER_BIT);
+    
+    // Use shader program
+    glUseProgram(shaderProgram);
+    
+    // Set projection matrix (map simulation coordinates to screen coordinates)
+    glm::mat4 projection = glm::ortho(0.0f, static_cast<float>(width), 0.0f, static_cast<float>(height));
+    GLint projectionLoc = glGetUniformLocation(shaderProgram, "projection");
+    glUniformMatrix4fv(projectionLoc, 1, GL_FALSE, glm::value_ptr(projection));
+    
     // Update position buffer
     glBindBuffer(GL_ARRAY_BUFFER, vbo);
     glBufferData(GL_ARRAY_BUFFER, positions.size() * sizeof(glm::vec2), positions.data(), GL_DYNAMIC_DRAW);
@@ -161,7 +164,7 @@ void Renderer::render(const std::vector<Particle>& particles) {
     
     // Draw particles
     glBindVertexArray(vao);
-    glDrawArrays(GL_POINTS, 0, static_cast<GLsizei>(particles.size()));
+    glDrawArrays(GL_POINTS, 0, static_cast<GLsizei>(std::min(positions.size(), colors.size())));
     glBindVertexArray(0);
     
     // Swap buffers
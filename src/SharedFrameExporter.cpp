@@ -0,0 +1,226 @@
+#include "SharedFrameExporter.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstddef>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <system_error>
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+    // Take an exclusive lock on the lock file for a segment name, which
+    // serializes the stale check, unlink and create across producers.
+    // Returns the descriptor to close to release the lock, or -1.
+    int lockName(const std::string& name) {
+        std::error_code error;
+        std::filesystem::path directory = std::filesystem::temp_directory_path(error);
+        if (error) directory = "/tmp";
+
+        // The file is never deleted; removing lock files reintroduces the race
+        std::string path = (directory / ("sph_shm_" + name.substr(1) + ".lock")).string();
+        int fd = ::open(path.c_str(), O_RDONLY | O_CREAT | O_CLOEXEC, 0666);
+        if (fd < 0) {
+            std::cerr << "Failed to open lock file " << path << ": " << std::strerror(errno) << std::endl;
+            return -1;
+        }
+        while (flock(fd, LOCK_EX) != 0) {
+            if (errno == EINTR) continue;
+            std::cerr << "Failed to lock " << path << ": " << std::strerror(errno) << std::endl;
+            ::close(fd);
+            return -1;
+        }
+        return fd;
+    }
+}
+
+SharedFrameExporter::SharedFrameExporter()
+    : base(nullptr), size(0), header(nullptr), nextFrame(0) {
+}
+
+SharedFrameExporter::~SharedFrameExporter() {
+    close();
+}
+
+bool SharedFrameExporter::open(const std::string& name, uint32_t maxParticles, uint32_t slotCount) {
+    close();
+
+    if (name.size() < 2 || name[0] != '/' || name.find('/', 1) != std::string::npos) {
+        std::cerr << "Invalid shared memory name (expected \"/name\"): " << name << std::endl;
+        return false;
+    }
+
+    this->name = name;
+    nextFrame = 0;
+    return create(std::max<uint32_t>(1, maxParticles), std::max<uint32_t>(2, slotCount));
+}
+
+void SharedFrameExporter::close() {
+    destroy();
+    name.clear();
+}
+
+bool SharedFrameExporter::create(uint32_t maxParticles, uint32_t slotCount) {
+    // Slot: header, then particle records, padded to the alignment
+    size_t dataOffset = (sizeof(sph_shm_header) + SPH_SHM_ALIGNMENT - 1) / SPH_SHM_ALIGNMENT * SPH_SHM_ALIGNMENT;
+    size_t slotSize = SPH_SHM_SLOT_HEADER_SIZE + static_cast<size_t>(maxParticles) * sizeof(Particle);
+    slotSize = (slotSize + SPH_SHM_ALIGNMENT - 1) / SPH_SHM_ALIGNMENT * SPH_SHM_ALIGNMENT;
+    size_t totalSize = dataOffset + slotSize * slotCount;
+
+    // Never take over a live producer's segment; replace only stale ones.
+    // Producers hold the name's lock from the check until their segment
+    // exists, so two of them cannot both replace the same stale segment.
+    int lockFd = lockName(name);
+    if (lockFd < 0) return false;
+    int fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+    if (fd < 0 && errno == EEXIST && isStale(name)) {
+        shm_unlink(name.c_str());
+        fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+    }
+    int openError = errno;
+    ::close(lockFd);
+    errno = openError;
+    if (fd < 0) {
+        if (errno == EEXIST) {
+            std::cerr << "Shared memory " << name << " is in use by another producer" << std::endl;
+        } else {
+            std::cerr << "Failed to create shared memory " << name << ": " << std::strerror(errno) << std::endl;
+        }
+        return false;
+    }
+    if (ftruncate(fd, static_cast<off_t>(totalSize)) != 0) {
+        std::cerr << "Failed to size shared memory " << name << ": " << std::strerror(errno) << std::endl;
+        ::close(fd);
+        shm_unlink(name.c_str());
+        return false;
+    }
+
+    void* mapping = mmap(nullptr, totalSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (mapping == MAP_FAILED) {
+        std::cerr << "Failed to map shared memory " << name << ": " << std::strerror(errno) << std::endl;
+        shm_unlink(name.c_str());
+        return false;
+    }
+
+    base = static_cast<unsigned char*>(mapping);
+    size = totalSize;
+    header = reinterpret_cast<sph_shm_header*>(base);
+
+    // Fill the header; the magic is stored last so readers never see a partial header
+    header->version = SPH_SHM_VERSION;
+    header->slot_count = slotCount;
+    header->slot_size = slotSize;
+    header->data_offset = dataOffset;
+    header->max_particles = maxParticles;
+    header->closed = 0;
+    header->owner_pid = static_cast<uint32_t>(getpid());
+    header->reserved = 0;
+    header->layout.stride = sizeof(Particle);
+    header->layout.position_offset = offsetof(Particle, position);
+    header->layout.velocity_offset = offsetof(Particle, velocity);
+    header->layout.force_offset = offsetof(Particle, force);
+    header->layout.mass_offset = offsetof(Particle, mass);
+    header->layout.density_offset = offsetof(Particle, density);
+    header->layout.pressure_offset = offsetof(Particle, pressure);
+    header->layout.reserved = 0;
+    __atomic_store_n(&header->latest_frame, nextFrame, __ATOMIC_RELAXED);
+    __atomic_store_n(&header->magic, SPH_SHM_MAGIC, __ATOMIC_RELEASE);
+
+    return true;
+}
+
+void SharedFrameExporter::destroy() {
+    if (!header) return;
+
+    // Unlink before marking the segment closed, so that a producer replacing
+    // a closed segment can never unlink one created after ours. Attached
+    // readers then re-attach; their mappings stay valid until they unmap.
+    shm_unlink(name.c_str());
+    __atomic_store_n(&header->closed, 1u, __ATOMIC_RELEASE);
+    munmap(base, size);
+
+    base = nullptr;
+    size = 0;
+    header = nullptr;
+}
+
+bool SharedFrameExporter::isStale(const std::string& name) {
+    int fd = shm_open(name.c_str(), O_RDONLY, 0);
+    if (fd < 0) return errno == ENOENT;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        ::close(fd);
+        return false;
+    }
+
+    // Not (yet) a frame segment: it may be another producer still creating it
+    if (static_cast<size_t>(st.st_size) < sizeof(sph_shm_header)) {
+        ::close(fd);
+        return false;
+    }
+
+    void* mapping = mmap(nullptr, sizeof(sph_shm_header), PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (mapping == MAP_FAILED) return false;
+
+    // Stale if the producer closed it or has exited
+    const sph_shm_header* existing = static_cast<const sph_shm_header*>(mapping);
+    bool stale = __atomic_load_n(&existing->magic, __ATOMIC_ACQUIRE) == SPH_SHM_MAGIC &&
+                 (__atomic_load_n(&existing->closed, __ATOMIC_ACQUIRE) != 0 ||
+                  (kill(static_cast<pid_t>(existing->owner_pid), 0) != 0 && errno == ESRCH));
+    munmap(mapping, sizeof(sph_shm_header));
+    return stale;
+}
+
+bool SharedFrameExporter::publish(const std::vector<Particle>& particles, const sph_shm_params& params) {
+    if (!header) return false;
+
+    // Grow the segment if the frame does not fit
+    if (particles.size() > header->max_particles) {
+        uint32_t slotCount = header->slot_count;
+        uint64_t capacity = std::max<uint64_t>(particles.size(), 2ull * header->max_particles);
+        destroy();
+        if (!create(static_cast<uint32_t>(std::min<uint64_t>(capacity, UINT32_MAX)), slotCount)) {
+            return false;
+        }
+    }
+
+    uint64_t frame = nextFrame++;
+    sph_shm_slot* slot = reinterpret_cast<sph_shm_slot*>(
+        base + header->data_offset + (frame % header->slot_count) * header->slot_size);
+
+    // Seqlock write: odd sequence while the slot is inconsistent
+    __atomic_store_n(&slot->sequence, 2 * frame + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+
+    slot->frame_id = frame;
+    slot->particle_count = static_cast<uint32_t>(particles.size());
+    slot->params = params;
+    std::memcpy(reinterpret_cast<unsigned char*>(slot) + SPH_SHM_SLOT_HEADER_SIZE, particles.data(),
+                particles.size() * sizeof(Particle));
+
+    __atomic_store_n(&slot->sequence, 2 * frame + 2, __ATOMIC_RELEASE);
+    __atomic_store_n(&header->latest_frame, frame + 1, __ATOMIC_RELEASE);
+    return true;
+}
+
+bool SharedFrameExporter::publish(const Simulation& simulation) {
+    sph_shm_params params = {};
+    params.width = simulation.getWidth();
+    params.height = simulation.getHeight();
+    params.gravity_x = simulation.getGravity().x;
+    params.gravity_y = simulation.getGravity().y;
+    params.viscosity = simulation.getViscosity();
+    params.gas_constant = simulation.getGasConstant();
+    params.rest_density = simulation.getRestDensity();
+    params.smoothing_radius = simulation.getSmoothingRadius();
+    params.damping_coefficient = simulation.getDampingCoefficient();
+    return publish(simulation.getParticles(), params);
+}
@@ -1,10 +1,46 @@
 #include "Simulation.h"
 #include "SPHKernels.h"
+#include "ColorMap.h"
+#include "Cache.h"
 #include <random>
 #include <algorithm>
+#include <cmath>
+#include <cstdio>
+
+namespace {
+    // Upper bound on grid cells per particle; cells grow beyond the smoothing
+    // radius when it is tiny compared to the particles' bounding box
+    constexpr float MAX_CELLS_PER_PARTICLE = 4.0f;
+    constexpr float MIN_CELL_BUDGET = 256.0f;
+    
+    // Empty cells around the bounding box when the grid is laid out, and how
+    // far the grid may drift from the ideal before it is laid out again
+    constexpr int GRID_MARGIN = 2;
+    constexpr float MAX_CELL_SIZE_SLACK = 1.5f;
+    constexpr float MAX_GRID_SLACK = 4.0f;
+    
+    // Time step used while relaxing the initial state
+    constexpr float RELAXATION_DT = 0.01f;
+    
+    // Seed for Poisson-disk sampling, fixed so cached states are reproducible
+    constexpr unsigned int POISSON_SEED = 12345;
+    
+    // Bump when placement or relaxation changes to invalidate cached states
+    constexpr int WARM_START_VERSION = 2;
+    
+    // Smallest initial block edge relative to the spawn region
+    constexpr float MIN_REGION_FILL = 0.5f;
+    
+    // Relaxed states kept in the cache directory; least recently used are removed
+    constexpr size_t MAX_WARM_START_FILES = 32;
+}
 
 Simulation::Simulation(float width, float height)
-    : width(width), height(height) {
+    : width(width), height(height),
+      cellSize(0.0f), gridOrigin(0.0f), gridX(0), gridY(0), particleCellValid(false),
+      tilesX(0), tilesY(0), stepDt(0.0f),
+      initMode(InitMode::Lattice), relaxationSteps(20), warmStartCache(true),
+      tileSize(4), cellSizeScale(1.0f), reorderInterval(0), renderPacking(false), stepCount(0) {
     // Default simulation parameters
     gravity = glm::vec2(0.0f, -9.81f);
     viscosity = 0.1f;
@@ -19,6 +55,11 @@ Simulation::~Simulation() {
 }
 
 void Simulation::initialize(int numParticles) {
+    if (initMode != InitMode::Random) {
+        initializeRelaxed(numParticles);
+        return;
+    }
+    
     particles.clear();
     particles.reserve(numParticles);
     
@@ -36,76 +77,351 @@ void Simulation::initialize(int numParticles) {
         
         particles.emplace_back(position, velocity, mass);
     }
+    
+    // Grid assignment must be recomputed for the new particles
+    particleCellValid = false;
+    stepCount = 0;
+}
+
+void Simulation::initializeRelaxed(int numParticles) {
+    float mass = 1.0f;
+    std::string cachePath = warmStartCache ? warmStartPath(numParticles) : std::string();
+    
+    // Identical setups start from the cached relaxed state
+    std::vector<glm::vec2> positions;
+    if (!cachePath.empty() && InitialState::load(cachePath, static_cast<size_t>(std::max(numParticles, 0)), positions)) {
+        Cache::touch(cachePath);
+        particles.clear();
+        particles.reserve(positions.size());
+        for (const auto& position : positions) {
+            particles.emplace_back(position, glm::vec2(0.0f), mass);
+        }
+        particleCellValid = false;
+        stepCount = 0;
+        return;
+    }
+    
+    // Place particles at rest-density spacing in the upper spawn region
+    glm::vec2 regionMin(width * 0.25f, height * 0.5f);
+    glm::vec2 regionMax(width * 0.75f, height * 0.9f);
+    glm::vec2 domain(width, height);
+    float restSpacing = InitialState::restSpacing(mass, restDensity, smoothingRadius);
+    float spacing = restSpacing;
+    
+    // With unit mass the rest spacing is tiny next to the container, and a block
+    // packed that tightly would sit in a corner of the spawn region. Keep the
+    // block at least half the region's size, and fill the region if a lone
+    // particle already reaches rest density (any spacing beyond the smoothing
+    // radius is at rest then).
+    if (numParticles > 0) {
+        glm::vec2 region = regionMax - regionMin;
+        float fillSpacing = std::sqrt(region.x * region.y / numParticles);
+        spacing = std::max(spacing, spacing >= smoothingRadius ? fillSpacing : MIN_REGION_FILL * fillSpacing);
+    }
+    if (initMode == InitMode::PoissonDisk) {
+        positions = InitialState::poissonDisk(numParticles, regionMin, regionMax, domain, spacing, POISSON_SEED);
+    } else {
+        positions = InitialState::lattice(numParticles, regionMin, regionMax, domain, spacing);
+    }
+    
+    particles.clear();
+    particles.reserve(positions.size());
+    for (const auto& position : positions) {
+        particles.emplace_back(position, glm::vec2(0.0f), mass);
+    }
+    particleCellValid = false;
+    stepCount = 0;
+    
+    // Settle and cache the result. A block wider than the rest spacing is
+    // below rest density and has no pressure to relax.
+    if (relaxationSteps <= 0 || spacing > restSpacing) return;
+    relax(relaxationSteps, RELAXATION_DT);
+    if (!cachePath.empty()) {
+        positions.clear();
+        for (const auto& p : particles) positions.push_back(p.position);
+        if (InitialState::store(cachePath, positions)) {
+            Cache::prune(Cache::directory(), "initial-", ".bin", MAX_WARM_START_FILES);
+        }
+    }
+}
+
+void Simulation::relax(int steps, float dt) {
+    glm::vec2 savedGravity = gravity;
+    gravity = glm::vec2(0.0f);
+    
+    // Pressure pushes overlapping particles apart; dropping velocities after
+    // every step keeps the motion from building up into oscillations
+    for (int i = 0; i < steps; ++i) {
+        update(dt);
+        for (auto& p : particles) {
+            p.velocity = glm::vec2(0.0f);
+        }
+    }
+    
+    gravity = savedGravity;
+    for (auto& p : particles) {
+        p.resetForce();
+    }
+    stepCount = 0;
+}
+
+std::string Simulation::warmStartPath(int numParticles) const {
+    std::string directory = Cache::directory();
+    if (directory.empty()) return std::string();
+    
+    // Key on everything that affects placement and relaxation
+    char key[512];
+    std::snprintf(key, sizeof(key), "v%d n%d w%.9g h%.9g mode%d steps%d dt%.9g sr%.9g rho%.9g k%.9g mu%.9g d%.9g",
+                  WARM_START_VERSION, numParticles, width, height, static_cast<int>(initMode), relaxationSteps,
+                  RELAXATION_DT, smoothingRadius, restDensity, gasConstant, viscosity, dampingCoefficient);
+    return directory + "/initial-" + Cache::toHex(Cache::hash(std::string(key))) + ".bin";
+}
+
+void Simulation::setParticles(const std::vector<Particle>& newParticles) {
+    particles = newParticles;
+    
+    // Grid assignment must be recomputed for the new particles
+    particleCellValid = false;
+    stepCount = 0;
 }
 
 void Simulation::update(float dt) {
-    // Compute density and pressure
-    computeDensityPressure();
+    // Bin particles into the grid (cells were computed by the previous step)
+    rebuildGrid();
+    
+    // Resize render buffers written by the fused pass
+    if (renderPacking) {
+        packedPositions.resize(particles.size());
+        packedColors.resize(particles.size());
+    }
+    
+    // Run density, forces and the fused integrate pass per tile. Each tile
+    // starts as soon as its neighboring tiles have finished the previous phase.
+    stepDt = dt;
+    taskGraph.run(pool);
+    
+    particleCellValid = true;
+    ++stepCount;
+}
+
+void Simulation::rebuildGrid() {
+    size_t n = particles.size();
+    
+    // Bounding box of the particles, clipped to the container; particles
+    // outside it (or with non-finite positions) are clamped into border cells
+    glm::vec2 lo(width, height);
+    glm::vec2 hi(0.0f, 0.0f);
+    for (const auto& p : particles) {
+        lo = glm::min(lo, p.position);
+        hi = glm::max(hi, p.position);
+    }
+    lo = glm::clamp(lo, glm::vec2(0.0f), glm::vec2(width, height));
+    hi = glm::clamp(hi, lo, glm::vec2(width, height));
+    
+    // Cell size: at least the smoothing radius, but bounded in count over the box
+    glm::vec2 extent = hi - lo;
+    float cellBudget = std::max(MIN_CELL_BUDGET, MAX_CELLS_PER_PARTICLE * static_cast<float>(n));
+    float newCellSize = std::max(smoothingRadius * cellSizeScale, std::sqrt(extent.x * extent.y / cellBudget));
+    
+    // Keep the current grid while it covers the box with a suitable cell size
+    // and is not much larger than needed; a new grid gets a margin of cells so
+    // that it lasts for a while as the fluid moves
+    glm::vec2 gridMax = gridOrigin + cellSize * glm::vec2(gridX, gridY);
+    float neededCells = (extent.x / newCellSize + 1.0f + 2.0f * GRID_MARGIN) *
+                        (extent.y / newCellSize + 1.0f + 2.0f * GRID_MARGIN);
+    bool keep = gridX > 0 && cellSize >= newCellSize && cellSize <= MAX_CELL_SIZE_SLACK * newCellSize &&
+                lo.x >= gridOrigin.x && lo.y >= gridOrigin.y && hi.x < gridMax.x && hi.y < gridMax.y &&
+                static_cast<float>(gridX) * gridY <= MAX_GRID_SLACK * neededCells;
     
-    // Compute forces
-    computeForces();
+    if (!keep) {
+        cellSize = newCellSize;
+        gridOrigin = (glm::floor(lo / cellSize) - glm::vec2(static_cast<float>(GRID_MARGIN))) * cellSize;
+        gridX = static_cast<int>((hi.x - gridOrigin.x) / cellSize) + 1 + GRID_MARGIN;
+        gridY = static_cast<int>((hi.y - gridOrigin.y) / cellSize) + 1 + GRID_MARGIN;
+        particleCellValid = false;
+    }
+    
+    // Rebuild the task graph when the tile layout changes
+    int newTilesX = (gridX + tileSize - 1) / tileSize;
+    int newTilesY = (gridY + tileSize - 1) / tileSize;
+    if (newTilesX != tilesX || newTilesY != tilesY || taskGraph.getTaskCount() == 0) {
+        tilesX = newTilesX;
+        tilesY = newTilesY;
+        buildTaskGraph();
+    }
     
-    // Integrate
-    integrate(dt);
+    // Cells are normally computed by the fused pass of the previous step
+    if (!particleCellValid || particleCell.size() != n) {
+        particleCell.resize(n);
+        for (size_t i = 0; i < n; ++i) {
+            particleCell[i] = cellOf(particles[i].position);
+        }
+    }
+    
+    // Counting sort of particle indices by cell
+    size_t cellCount = static_cast<size_t>(gridX) * gridY;
+    cellStart.assign(cellCount + 1, 0);
+    for (size_t i = 0; i < n; ++i) {
+        ++cellStart[particleCell[i] + 1];
+    }
+    for (size_t c = 0; c < cellCount; ++c) {
+        cellStart[c + 1] += cellStart[c];
+    }
+    cellParticles.resize(n);
+    cellCursor.assign(cellStart.begin(), cellStart.end() - 1);
+    for (size_t i = 0; i < n; ++i) {
+        cellParticles[cellCursor[particleCell[i]]++] = static_cast<std::uint32_t>(i);
+    }
+    
+    // Periodically store particles in cell order for memory locality
+    if (reorderInterval > 0 && stepCount % reorderInterval == 0) {
+        reorderScratch.resize(n);
+        for (size_t k = 0; k < n; ++k) {
+            reorderScratch[k] = particles[cellParticles[k]];
+        }
+        particles.swap(reorderScratch);
+        
+        for (size_t c = 0; c < cellCount; ++c) {
+            for (std::uint32_t k = cellStart[c]; k < cellStart[c + 1]; ++k) {
+                particleCell[k] = static_cast<std::uint32_t>(c);
+                cellParticles[k] = k;
+            }
+        }
+    }
+}
+
+void Simulation::buildTaskGraph() {
+    taskGraph.clear();
+    
+    int tileCount = tilesX * tilesY;
+    std::vector<int> densityTasks(tileCount);
+    std::vector<int> forceTasks(tileCount);
+    std::vector<int> integrateTasks(tileCount);
+    
+    for (int t = 0; t < tileCount; ++t) {
+        densityTasks[t] = taskGraph.addTask([this, t] { computeDensityPressure(t); });
+        forceTasks[t] = taskGraph.addTask([this, t] { computeForces(t); });
+        integrateTasks[t] = taskGraph.addTask([this, t] { integrate(t); });
+    }
+    
+    // Forces of a tile read densities of neighboring tiles, and integrating a
+    // tile moves particles that neighboring tiles read forces from
+    for (int ty = 0; ty < tilesY; ++ty) {
+        for (int tx = 0; tx < tilesX; ++tx) {
+            int t = ty * tilesX + tx;
+            for (int ny = std::max(ty - 1, 0); ny <= std::min(ty + 1, tilesY - 1); ++ny) {
+                for (int nx = std::max(tx - 1, 0); nx <= std::min(tx + 1, tilesX - 1); ++nx) {
+                    int neighbor = ny * tilesX + nx;
+                    taskGraph.addDependency(densityTasks[neighbor], forceTasks[t]);
+                    taskGraph.addDependency(forceTasks[neighbor], integrateTasks[t]);
+                }
+            }
+        }
+    }
+}
+
+std::uint32_t Simulation::cellOf(const glm::vec2& position) const {
+    // Positions outside the grid are clamped to the border cells, and NaN
+    // coordinates fall into the first cell
+    float fx = (position.x - gridOrigin.x) / cellSize;
+    float fy = (position.y - gridOrigin.y) / cellSize;
+    int cx = fx > 0.0f ? static_cast<int>(std::min(fx, static_cast<float>(gridX - 1))) : 0;
+    int cy = fy > 0.0f ? static_cast<int>(std::min(fy, static_cast<float>(gridY - 1))) : 0;
+    return static_cast<std::uint32_t>(cy * gridX + cx);
+}
+
+template <typename Body>
+void Simulation::forEachInTile(int tile, Body body) {
+    int cx0 = (tile % tilesX) * tileSize;
+    int cy0 = (tile / tilesX) * tileSize;
+    int cx1 = std::min(cx0 + tileSize, gridX);
+    int cy1 = std::min(cy0 + tileSize, gridY);
     
-    // Handle boundaries
-    handleBoundaries();
+    for (int cy = cy0; cy < cy1; ++cy) {
+        for (int cx = cx0; cx < cx1; ++cx) {
+            int cell = cy * gridX + cx;
+            for (std::uint32_t k = cellStart[cell]; k < cellStart[cell + 1]; ++k) {
+                body(cellParticles[k], cx, cy);
+            }
+        }
+    }
 }
 
-void Simulation::computeDensityPressure() {
-    // For each particle
-    for (auto& pi : particles) {
+void Simulation::computeDensityPressure(int tile) {
+    // For each particle in the tile
+    forEachInTile(tile, [this](std::uint32_t i, int cx, int cy) {
+        Particle& pi = particles[i];
+        
         // Reset density
         pi.density = 0.0f;
         
-        // Compute density using Poly6 kernel
-        for (const auto& pj : particles) {
-            glm::vec2 r = pi.position - pj.position;
-            pi.density += pj.mass * SPHKernels::Poly6::W(r, smoothingRadius);
+        // Compute density using Poly6 kernel over the neighboring cells
+        for (int ny = std::max(cy - 1, 0); ny <= std::min(cy + 1, gridY - 1); ++ny) {
+            for (int nx = std::max(cx - 1, 0); nx <= std::min(cx + 1, gridX - 1); ++nx) {
+                int cell = ny * gridX + nx;
+                for (std::uint32_t k = cellStart[cell]; k < cellStart[cell + 1]; ++k) {
+                    const Particle& pj = particles[cellParticles[k]];
+                    glm::vec2 r = pi.position - pj.position;
+                    pi.density += pj.mass * SPHKernels::Poly6::W(r, smoothingRadius);
+                }
+            }
         }
         
         // Compute pressure using equation of state
         pi.pressure = gasConstant * (pi.density - restDensity);
         if (pi.pressure < 0.0f) pi.pressure = 0.0f; // Prevent negative pressure
-    }
+    });
 }
 
-void Simulation::computeForces() {
-    // For each particle
-    for (auto& pi : particles) {
+void Simulation::computeForces(int tile) {
+    // For each particle in the tile
+    forEachInTile(tile, [this](std::uint32_t i, int cx, int cy) {
+        Particle& pi = particles[i];
+        
         // Reset forces
         pi.resetForce();
         
         // Add gravity
         pi.force += gravity * pi.mass;
         
-        // For each other particle
-        for (const auto& pj : particles) {
-            if (&pi == &pj) continue; // Skip self
-            
-            glm::vec2 r = pi.position - pj.position;
-            float r_len = glm::length(r);
-            
-            // Skip if particles are too far apart
-            if (r_len >= smoothingRadius) continue;
-            
-            // Pressure force using Spiky kernel
-            glm::vec2 pressureForce = -pj.mass * (pi.pressure + pj.pressure) / (2.0f * pj.density) * 
-                                      SPHKernels::Spiky::gradW(r, smoothingRadius);
-            
-            // Viscosity force using Viscosity kernel
-            glm::vec2 viscosityForce = viscosity * pj.mass * (pj.velocity - pi.velocity) / pj.density * 
-                                      SPHKernels::Viscosity::laplacianW(r, smoothingRadius);
-            
-            // Add forces
-            pi.force += pressureForce + viscosityForce;
+        // For each other particle in the neighboring cells
+        for (int ny = std::max(cy - 1, 0); ny <= std::min(cy + 1, gridY - 1); ++ny) {
+            for (int nx = std::max(cx - 1, 0); nx <= std::min(cx + 1, gridX - 1); ++nx) {
+                int cell = ny * gridX + nx;
+                for (std::uint32_t k = cellStart[cell]; k < cellStart[cell + 1]; ++k) {
+                    std::uint32_t j = cellParticles[k];
+                    if (i == j) continue; // Skip self
+                    const Particle& pj = particles[j];
+                    
+                    glm::vec2 r = pi.position - pj.position;
+                    float r_len = glm::length(r);
+                    
+                    // Skip if particles are too far apart
+                    if (r_len >= smoothingRadius) continue;
+                    
+                    // Pressure force using Spiky kernel
+                    glm::vec2 pressureForce = -pj.mass * (pi.pressure + pj.pressure) / (2.0f * pj.density) *
+                                              SPHKernels::Spiky::gradW(r, smoothingRadius);
+                    
+                    // Viscosity force using Viscosity kernel
+                    glm::vec2 viscosityForce = viscosity * pj.mass * (pj.velocity - pi.velocity) / pj.density *
+                                              SPHKernels::Viscosity::laplacianW(r, smoothingRadius);
+                    
+                    // Add forces
+                    pi.force += pressureForce + viscosityForce;
+                }
+            }
         }
-    }
+    });
 }
 
-void Simulation::integrate(float dt) {
-    // For each particle
-    for (auto& p : particles) {
+void Simulation::integrate(int tile) {
+    float dt = stepDt;
+    
+    // For each particle in the tile
+    forEachInTile(tile, [this, dt](std::uint32_t i, int, int) {
+        Particle& p = particles[i];
+        
         // Compute acceleration
         glm::vec2 acceleration = p.force / p.density;
         
@@ -114,34 +430,43 @@ void Simulation::integrate(float dt) {
         
         // Update position
         p.position += p.velocity * dt;
-    }
-}
-
-void Simulation::handleBoundaries() {
-    // For each particle
-    for (auto& p : particles) {
-        // Left boundary
-        if (p.position.x < 0.0f) {
-            p.position.x = 0.0f;
-            p.velocity.x = -p.velocity.x * dampingCoefficient;
-        }
         
-        // Right boundary
-        if (p.position.x > width) {
-            p.position.x = width;
-            p.velocity.x = -p.velocity.x * dampingCoefficient;
-        }
+        // Handle boundaries
+        handleBoundaries(p);
         
-        // Bottom boundary
-        if (p.position.y < 0.0f) {
-            p.position.y = 0.0f;
-            p.velocity.y = -p.velocity.y * dampingCoefficient;
-        }
+        // Bin into the grid for the next step
+        particleCell[i] = cellOf(p.position);
         
-        // Top boundary
-        if (p.position.y > height) {
-            p.position.y = height;
-            p.velocity.y = -p.velocity.y * dampingCoefficient;
+        // Pack render buffers while the particle is in cache
+        if (renderPacking) {
+            packedPositions[i] = p.position;
+            packedColors[i] = ColorMap::densityToColor(p.density);
         }
+    });
+}
+
+void Simulation::handleBoundaries(Particle& p) {
+    // Left boundary
+    if (p.position.x < 0.0f) {
+        p.position.x = 0.0f;
+        p.velocity.x = -p.velocity.x * dampingCoefficient;
+    }
+    
+    // Right boundary
+    if (p.position.x > width) {
+        p.position.x = width;
+        p.velocity.x = -p.velocity.x * dampingCoefficient;
+    }
+    
+    // Bottom boundary
+    if (p.position.y < 0.0f) {
+        p.position.y = 0.0f;
+        p.velocity.y = -p.velocity.y * dampingCoefficient;
+    }
+    
+    // Top boundary
+    if (p.position.y > height) {
+        p.position.y = height;
+        p.velocity.y = -p.velocity.y * dampingCoefficient;
     }
 } 
\ No newline at end of file
@@ -0,0 +1,238 @@
+#include "SoftwareRenderer.h"
+#include "ColorMap.h"
+#include "ImageWriter.h"
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+
+namespace {
+    // Background color (matches glClearColor in Renderer)
+    constexpr std::uint8_t BACKGROUND = 26;
+
+    // Pixel rectangle covered by a sprite, in framebuffer rows (top row first)
+    struct SpriteBounds {
+        int x0, x1;     // Inclusive column range
+        int y0, y1;     // Inclusive row range
+    };
+
+    // Pixels whose centers lie within the sprite radius, clipped to the screen
+    bool spriteBounds(const Particle& p, float radius, int width, int height, SpriteBounds& b) {
+        if (!std::isfinite(p.position.x) || !std::isfinite(p.position.y)) return false;
+
+        float x = p.position.x;
+        float y = p.position.y;
+        int px0 = static_cast<int>(std::ceil(x - radius - 0.5f));
+        int px1 = static_cast<int>(std::floor(x + radius - 0.5f));
+        int py0 = static_cast<int>(std::ceil(y - radius - 0.5f));
+        int py1 = static_cast<int>(std::floor(y + radius - 0.5f));
+
+        // Flip from GL window coordinates (origin bottom-left) to rows
+        b.x0 = std::max(px0, 0);
+        b.x1 = std::min(px1, width - 1);
+        b.y0 = std::max(height - 1 - py1, 0);
+        b.y1 = std::min(height - 1 - py0, height - 1);
+        return b.x0 <= b.x1 && b.y0 <= b.y1;
+    }
+
+    std::uint8_t toByte(float c) {
+        return static_cast<std::uint8_t>(std::clamp(c, 0.0f, 1.0f) * 255.0f + 0.5f);
+    }
+}
+
+SoftwareRenderer::SoftwareRenderer(int width, int height, int threadCount)
+    : width(width), height(height), tileSize(32), tilesX(0), tilesY(0),
+      pointSize(10.0f), output(FrameOutput::None), outputPattern("frame_%05d"), frameNumber(0),
+      pool(threadCount) {
+}
+
+bool SoftwareRenderer::initialize() {
+    if (width <= 0 || height <= 0) {
+        std::cerr << "Invalid framebuffer size " << width << "x" << height << std::endl;
+        return false;
+    }
+
+    framebuffer.assign(static_cast<size_t>(width) * height * 3, BACKGROUND);
+    setTileSize(tileSize);
+    return true;
+}
+
+void SoftwareRenderer::setTileSize(int size) {
+    tileSize = std::max(8, size);
+    tilesX = (width + tileSize - 1) / tileSize;
+    tilesY = (height + tileSize - 1) / tileSize;
+    tileStart.assign(static_cast<size_t>(tilesX) * tilesY + 1, 0);
+}
+
+bool SoftwareRenderer::setOutput(FrameOutput output, const std::string& pattern) {
+    // The pattern becomes a format string; anything but one integer conversion is undefined
+    if (!isValidPattern(pattern)) {
+        std::cerr << "Invalid frame pattern (expected exactly one %d): " << pattern << std::endl;
+        return false;
+    }
+
+    this->output = output;
+    outputPattern = pattern;
+    return true;
+}
+
+bool SoftwareRenderer::isValidPattern(const std::string& pattern) {
+    int conversions = 0;
+    for (size_t i = 0; i < pattern.size(); ++i) {
+        if (pattern[i] != '%') continue;
+        if (++i < pattern.size() && pattern[i] == '%') continue;
+
+        // Flags, width and precision, then the conversion itself
+        while (i < pattern.size() && std::strchr("-+ #0", pattern[i])) ++i;
+        while (i < pattern.size() && std::isdigit(static_cast<unsigned char>(pattern[i]))) ++i;
+        if (i < pattern.size() && pattern[i] == '.') {
+            ++i;
+            while (i < pattern.size() && std::isdigit(static_cast<unsigned char>(pattern[i]))) ++i;
+        }
+        if (i >= pattern.size() || (pattern[i] != 'd' && pattern[i] != 'i')) return false;
+        ++conversions;
+    }
+    return conversions == 1;
+}
+
+bool SoftwareRenderer::render(const std::vector<Particle>& particles) {
+    binParticles(particles);
+
+    // Rasterize tiles in parallel; each tile owns its pixels
+    pool.parallelFor(static_cast<size_t>(tilesX) * tilesY, [&](size_t tile) {
+        rasterizeTile(static_cast<int>(tile), particles);
+    });
+
+    bool written = writeFrame();
+    ++frameNumber;
+    return written;
+}
+
+void SoftwareRenderer::binParticles(const std::vector<Particle>& particles) {
+    size_t tileCount = static_cast<size_t>(tilesX) * tilesY;
+    size_t chunkCount = static_cast<size_t>(pool.getThreadCount());
+    size_t particleCount = particles.size();
+    float radius = 0.5f * pointSize;
+
+    auto chunkRange = [&](size_t chunk, size_t& begin, size_t& end) {
+        begin = chunk * particleCount / chunkCount;
+        end = (chunk + 1) * particleCount / chunkCount;
+    };
+
+    // Count tile overlaps per contiguous chunk of particles
+    binCounts.assign(chunkCount * tileCount, 0);
+    pool.parallelFor(chunkCount, [&](size_t chunk) {
+        std::uint32_t* counts = binCounts.data() + chunk * tileCount;
+        size_t begin, end;
+        chunkRange(chunk, begin, end);
+        for (size_t i = begin; i < end; ++i) {
+            SpriteBounds b;
+            if (!spriteBounds(particles[i], radius, width, height, b)) continue;
+            for (int ty = b.y0 / tileSize; ty <= b.y1 / tileSize; ++ty) {
+                for (int tx = b.x0 / tileSize; tx <= b.x1 / tileSize; ++tx) {
+                    ++counts[ty * tilesX + tx];
+                }
+            }
+        }
+    });
+
+    // Prefix sum: tiles in order, chunks in order within a tile, so every
+    // tile list ends up sorted by particle index
+    std::uint32_t offset = 0;
+    for (size_t tile = 0; tile < tileCount; ++tile) {
+        tileStart[tile] = offset;
+        for (size_t chunk = 0; chunk < chunkCount; ++chunk) {
+            std::uint32_t count = binCounts[chunk * tileCount + tile];
+            binCounts[chunk * tileCount + tile] = offset;
+            offset += count;
+        }
+    }
+    tileStart[tileCount] = offset;
+    tileParticles.resize(offset);
+
+    // Scatter particle indices into their tiles
+    pool.parallelFor(chunkCount, [&](size_t chunk) {
+        std::uint32_t* cursors = binCounts.data() + chunk * tileCount;
+        size_t begin, end;
+        chunkRange(chunk, begin, end);
+        for (size_t i = begin; i < end; ++i) {
+            SpriteBounds b;
+            if (!spriteBounds(particles[i], radius, width, height, b)) continue;
+            for (int ty = b.y0 / tileSize; ty <= b.y1 / tileSize; ++ty) {
+                for (int tx = b.x0 / tileSize; tx <= b.x1 / tileSize; ++tx) {
+                    tileParticles[cursors[ty * tilesX + tx]++] = static_cast<std::uint32_t>(i);
+                }
+            }
+        }
+    });
+}
+
+void SoftwareRenderer::rasterizeTile(int tile, const std::vector<Particle>& particles) {
+    int tx = tile % tilesX;
+    int ty = tile / tilesX;
+    int x0 = tx * tileSize;
+    int y0 = ty * tileSize;
+    int x1 = std::min(x0 + tileSize, width) - 1;
+    int y1 = std::min(y0 + tileSize, height) - 1;
+    float radius = 0.5f * pointSize;
+    float radius2 = radius * radius;
+
+    // Clear the tile
+    for (int y = y0; y <= y1; ++y) {
+        std::uint8_t* row = framebuffer.data() + (static_cast<size_t>(y) * width + x0) * 3;
+        std::fill(row, row + (x1 - x0 + 1) * 3, BACKGROUND);
+    }
+
+    // Draw circular sprites in particle order (later particles on top)
+    for (std::uint32_t k = tileStart[tile]; k < tileStart[tile + 1]; ++k) {
+        const Particle& p = particles[tileParticles[k]];
+        SpriteBounds b;
+        if (!spriteBounds(p, radius, width, height, b)) continue;
+
+        glm::vec3 color = ColorMap::densityToColor(p.density);
+        std::uint8_t r = toByte(color.x);
+        std::uint8_t g = toByte(color.y);
+        std::uint8_t bl = toByte(color.z);
+
+        int cx0 = std::max(b.x0, x0), cx1 = std::min(b.x1, x1);
+        int cy0 = std::max(b.y0, y0), cy1 = std::min(b.y1, y1);
+        for (int y = cy0; y <= cy1; ++y) {
+            // Row back to GL window coordinates for the distance test
+            float dy = (height - 1 - y) + 0.5f - p.position.y;
+            std::uint8_t* pixel = framebuffer.data() + (static_cast<size_t>(y) * width + cx0) * 3;
+            for (int x = cx0; x <= cx1; ++x, pixel += 3) {
+                float dx = x + 0.5f - p.position.x;
+                if (dx * dx + dy * dy > radius2) continue;
+                pixel[0] = r;
+                pixel[1] = g;
+                pixel[2] = bl;
+            }
+        }
+    }
+}
+
+bool SoftwareRenderer::writeFrame() {
+    if (output == FrameOutput::None) return true;
+
+    if (output == FrameOutput::RawStdout) {
+        size_t written = std::fwrite(framebuffer.data(), 1, framebuffer.size(), stdout);
+        std::fflush(stdout);
+        if (written != framebuffer.size()) {
+            std::cerr << "Failed to write frame to stdout" << std::endl;
+            return false;
+        }
+        return true;
+    }
+
+    // Build the numbered file name from the pattern
+    char name[1024];
+    std::snprintf(name, sizeof(name), outputPattern.c_str(), frameNumber);
+    std::string path(name);
+
+    if (output == FrameOutput::PNG) {
+        return ImageWriter::writePNG(path + ".png", width, height, framebuffer.data(), &pool);
+    }
+    return ImageWriter::writePPM(path + ".ppm", width, height, framebuffer.data());
+}
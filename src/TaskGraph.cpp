@@ -0,0 +1,87 @@
+#include "TaskGraph.h"
+
+TaskGraph::TaskGraph()
+    : completedTasks(0) {
+}
+
+void TaskGraph::clear() {
+    tasks.clear();
+    remainingDependencies.reset();
+}
+
+int TaskGraph::addTask(std::function<void()> task) {
+    tasks.emplace_back();
+    tasks.back().function = std::move(task);
+    remainingDependencies.reset();
+    return static_cast<int>(tasks.size()) - 1;
+}
+
+void TaskGraph::addDependency(int before, int after) {
+    tasks[before].successors.push_back(after);
+    ++tasks[after].dependencyCount;
+}
+
+void TaskGraph::run(ThreadPool& pool) {
+    if (tasks.empty()) return;
+
+    // Reset dependency counters and seed the ready list with root tasks
+    if (!remainingDependencies) {
+        remainingDependencies.reset(new std::atomic<int>[tasks.size()]);
+    }
+    readyTasks.clear();
+    readyTasks.reserve(tasks.size());
+    for (size_t i = tasks.size(); i-- > 0;) {
+        remainingDependencies[i].store(tasks[i].dependencyCount, std::memory_order_relaxed);
+        if (tasks[i].dependencyCount == 0) readyTasks.push_back(static_cast<int>(i));
+    }
+    completedTasks = 0;
+
+    pool.run([this](int) { worker(); });
+}
+
+void TaskGraph::worker() {
+    int task = -1;
+    for (;;) {
+        // Take a ready task unless a continuation is already lined up
+        if (task < 0) {
+            std::unique_lock<std::mutex> lock(readyMutex);
+            readyCondition.wait(lock, [this] {
+                return !readyTasks.empty() || completedTasks == tasks.size();
+            });
+            if (readyTasks.empty()) return;
+            task = readyTasks.back();
+            readyTasks.pop_back();
+        }
+
+        tasks[task].function();
+        task = complete(task);
+    }
+}
+
+int TaskGraph::complete(int task) {
+    // Release successors; keep the first one for this thread and queue the
+    // rest directly (readyTasks has room for every task, so this never allocates)
+    int next = -1;
+    int released = 0;
+    std::unique_lock<std::mutex> lock(readyMutex, std::defer_lock);
+    for (int successor : tasks[task].successors) {
+        if (remainingDependencies[successor].fetch_sub(1, std::memory_order_acq_rel) != 1) continue;
+        if (next < 0) {
+            next = successor;
+            continue;
+        }
+        if (!lock.owns_lock()) lock.lock();
+        readyTasks.push_back(successor);
+        ++released;
+    }
+
+    if (!lock.owns_lock()) lock.lock();
+    bool finished = ++completedTasks == tasks.size();
+    lock.unlock();
+
+    if (finished) readyCondition.notify_all();
+    else if (released == 1) readyCondition.notify_one();
+    else if (released > 1) readyCondition.notify_all();
+
+    return next;
+}
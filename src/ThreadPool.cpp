@@ -0,0 +1,102 @@
+#include "ThreadPool.h"
+#include <algorithm>
+#include <atomic>
+
+ThreadPool::ThreadPool(int threadCount)
+    : job(nullptr), generation(0), pendingWorkers(0), stopping(false) {
+    startWorkers((threadCount > 0 ? threadCount : hardwareThreads()) - 1);
+}
+
+ThreadPool::~ThreadPool() {
+    stopWorkers();
+}
+
+void ThreadPool::setThreadCount(int threadCount) {
+    if (threadCount <= 0) threadCount = hardwareThreads();
+    if (threadCount == getThreadCount()) return;
+
+    stopWorkers();
+    startWorkers(threadCount - 1);
+}
+
+void ThreadPool::run(const std::function<void(int)>& job) {
+    if (workers.empty()) {
+        job(0);
+        return;
+    }
+
+    // Publish the job to the workers
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        this->job = &job;
+        pendingWorkers = static_cast<int>(workers.size());
+        ++generation;
+    }
+    jobAvailable.notify_all();
+
+    // The calling thread takes part as thread 0
+    job(0);
+
+    // Wait for the workers to finish
+    std::unique_lock<std::mutex> lock(mutex);
+    jobFinished.wait(lock, [this] { return pendingWorkers == 0; });
+    this->job = nullptr;
+}
+
+void ThreadPool::parallelFor(size_t count, const std::function<void(size_t)>& body) {
+    if (count == 0) return;
+    if (count == 1 || workers.empty()) {
+        for (size_t i = 0; i < count; ++i) body(i);
+        return;
+    }
+
+    std::atomic<size_t> next(0);
+    run([&](int) {
+        for (size_t i = next.fetch_add(1, std::memory_order_relaxed); i < count;
+             i = next.fetch_add(1, std::memory_order_relaxed)) {
+            body(i);
+        }
+    });
+}
+
+int ThreadPool::hardwareThreads() {
+    return std::max(1u, std::thread::hardware_concurrency());
+}
+
+void ThreadPool::startWorkers(int workerCount) {
+    stopping = false;
+    workers.reserve(std::max(0, workerCount));
+    for (int i = 0; i < workerCount; ++i) {
+        workers.emplace_back(&ThreadPool::workerLoop, this, i + 1, generation);
+    }
+}
+
+void ThreadPool::stopWorkers() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    jobAvailable.notify_all();
+    for (auto& worker : workers) worker.join();
+    workers.clear();
+}
+
+void ThreadPool::workerLoop(int threadIndex, unsigned long long seenGeneration) {
+    for (;;) {
+        const std::function<void(int)>* currentJob;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            jobAvailable.wait(lock, [&] { return stopping || generation != seenGeneration; });
+            if (stopping) return;
+            seenGeneration = generation;
+            currentJob = job;
+        }
+
+        (*currentJob)(threadIndex);
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (--pendingWorkers == 0) jobFinished.notify_one();
+        }
+    }
+}
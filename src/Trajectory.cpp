@@ -0,0 +1,601 @@
+#include "Trajectory.h"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <limits>
+
+namespace {
+    // File layout constants
+    const char FILE_MAGIC[8] = {'S', 'P', 'H', 'T', 'R', 'A', 'J', '1'};
+    const char INDEX_MAGIC[8] = {'S', 'P', 'H', 'T', 'I', 'D', 'X', '1'};
+    constexpr std::uint32_t FILE_VERSION = 1;
+    constexpr size_t FILE_HEADER_SIZE = 8 + 4 + 4 + 5 * 4;
+    constexpr size_t FRAME_HEADER_SIZE = 1 + 4 + 8 + 4 + 4;
+    constexpr size_t INDEX_ENTRY_SIZE = 8 + 4 + 4 + 8 + 1;
+    constexpr size_t FOOTER_SIZE = 8 + 8;
+
+    // Frame flags
+    constexpr std::uint8_t FLAG_KEYFRAME = 1;
+    constexpr std::uint8_t FLAG_ENTROPY_CODED = 2;
+
+    // Quantized channels stored per particle (planar layout)
+    constexpr int CHANNEL_COUNT = 7;
+
+    // rANS entropy coder parameters
+    constexpr std::uint32_t RANS_SCALE_BITS = 12;
+    constexpr std::uint32_t RANS_SCALE = 1u << RANS_SCALE_BITS;
+    constexpr std::uint32_t RANS_LOWER_BOUND = 1u << 23;
+
+    // Little-endian serialization helpers
+    void putU8(std::vector<std::uint8_t>& out, std::uint8_t v) {
+        out.push_back(v);
+    }
+
+    void putU16(std::vector<std::uint8_t>& out, std::uint16_t v) {
+        out.push_back(static_cast<std::uint8_t>(v));
+        out.push_back(static_cast<std::uint8_t>(v >> 8));
+    }
+
+    void putU32(std::vector<std::uint8_t>& out, std::uint32_t v) {
+        for (int i = 0; i < 4; ++i) out.push_back(static_cast<std::uint8_t>(v >> (8 * i)));
+    }
+
+    void putU64(std::vector<std::uint8_t>& out, std::uint64_t v) {
+        for (int i = 0; i < 8; ++i) out.push_back(static_cast<std::uint8_t>(v >> (8 * i)));
+    }
+
+    void putF32(std::vector<std::uint8_t>& out, float v) {
+        std::uint32_t bits;
+        std::memcpy(&bits, &v, sizeof(bits));
+        putU32(out, bits);
+    }
+
+    std::uint16_t getU16(const std::uint8_t* p) {
+        return static_cast<std::uint16_t>(p[0] | (p[1] << 8));
+    }
+
+    std::uint32_t getU32(const std::uint8_t* p) {
+        std::uint32_t v = 0;
+        for (int i = 0; i < 4; ++i) v |= static_cast<std::uint32_t>(p[i]) << (8 * i);
+        return v;
+    }
+
+    std::uint64_t getU64(const std::uint8_t* p) {
+        std::uint64_t v = 0;
+        for (int i = 0; i < 8; ++i) v |= static_cast<std::uint64_t>(p[i]) << (8 * i);
+        return v;
+    }
+
+    float getF32(const std::uint8_t* p) {
+        std::uint32_t bits = getU32(p);
+        float v;
+        std::memcpy(&v, &bits, sizeof(v));
+        return v;
+    }
+
+    // Zigzag varint coding of signed deltas
+    void putVarint(std::vector<std::uint8_t>& out, std::int32_t value) {
+        std::uint32_t v = (static_cast<std::uint32_t>(value) << 1) ^ static_cast<std::uint32_t>(value >> 31);
+        while (v >= 0x80) {
+            out.push_back(static_cast<std::uint8_t>(v | 0x80));
+            v >>= 7;
+        }
+        out.push_back(static_cast<std::uint8_t>(v));
+    }
+
+    bool getVarint(const std::uint8_t*& p, const std::uint8_t* end, std::int32_t& value) {
+        std::uint32_t v = 0;
+        for (int shift = 0; shift < 35; shift += 7) {
+            if (p == end) return false;
+            std::uint8_t byte = *p++;
+            v |= static_cast<std::uint32_t>(byte & 0x7f) << shift;
+            if (!(byte & 0x80)) {
+                value = static_cast<std::int32_t>((v >> 1) ^ (~(v & 1) + 1));
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Quantize a value to an integer step, saturating at the int32 range
+    std::int32_t quantize(float value, float step) {
+        if (!std::isfinite(value)) return 0;
+        double q = std::round(static_cast<double>(value) / step);
+        q = std::clamp(q, static_cast<double>(std::numeric_limits<std::int32_t>::min()),
+                       static_cast<double>(std::numeric_limits<std::int32_t>::max()));
+        return static_cast<std::int32_t>(q);
+    }
+
+    // Normalize symbol counts to frequencies summing to RANS_SCALE
+    void normalizeFrequencies(const std::array<std::uint32_t, 256>& counts, size_t total,
+                              std::array<std::uint32_t, 256>& freqs) {
+        std::uint32_t sum = 0;
+        int largest = 0;
+        for (int s = 0; s < 256; ++s) {
+            if (counts[s] == 0) {
+                freqs[s] = 0;
+                continue;
+            }
+            std::uint64_t scaled = static_cast<std::uint64_t>(counts[s]) * RANS_SCALE / total;
+            freqs[s] = std::max<std::uint32_t>(1, static_cast<std::uint32_t>(scaled));
+            sum += freqs[s];
+            if (freqs[s] > freqs[largest]) largest = s;
+        }
+
+        // Fix rounding so the table sums to exactly RANS_SCALE
+        while (sum > RANS_SCALE) {
+            int target = largest;
+            for (int s = 0; s < 256; ++s) {
+                if (freqs[s] > freqs[target]) target = s;
+            }
+            std::uint32_t excess = std::min(sum - RANS_SCALE, freqs[target] - 1);
+            freqs[target] -= excess;
+            sum -= excess;
+            if (excess == 0) break;
+        }
+        freqs[largest] += RANS_SCALE - sum;
+    }
+
+    // Entropy-code bytes with a static order-0 rANS coder.
+    // Output: symbol table followed by the rANS stream.
+    void ransEncode(const std::vector<std::uint8_t>& input, std::vector<std::uint8_t>& output) {
+        output.clear();
+        if (input.empty()) return;
+
+        std::array<std::uint32_t, 256> counts{};
+        for (std::uint8_t b : input) ++counts[b];
+
+        std::array<std::uint32_t, 256> freqs{};
+        normalizeFrequencies(counts, input.size(), freqs);
+
+        std::array<std::uint32_t, 256> starts{};
+        std::uint32_t cumulative = 0;
+        std::uint16_t usedSymbols = 0;
+        for (int s = 0; s < 256; ++s) {
+            starts[s] = cumulative;
+            cumulative += freqs[s];
+            if (freqs[s]) ++usedSymbols;
+        }
+
+        // Symbol table
+        putU16(output, usedSymbols);
+        for (int s = 0; s < 256; ++s) {
+            if (!freqs[s]) continue;
+            putU8(output, static_cast<std::uint8_t>(s));
+            putU16(output, static_cast<std::uint16_t>(freqs[s] - 1));
+        }
+        size_t tableSize = output.size();
+
+        // Encode in reverse so the decoder can run forwards
+        std::uint32_t state = RANS_LOWER_BOUND;
+        for (size_t i = input.size(); i-- > 0;) {
+            std::uint8_t s = input[i];
+            std::uint32_t freq = freqs[s];
+            std::uint32_t maxState = ((RANS_LOWER_BOUND >> RANS_SCALE_BITS) << 8) * freq;
+            while (state >= maxState) {
+                output.push_back(static_cast<std::uint8_t>(state & 0xff));
+                state >>= 8;
+            }
+            state = ((state / freq) << RANS_SCALE_BITS) + (state % freq) + starts[s];
+        }
+        for (int i = 3; i >= 0; --i) output.push_back(static_cast<std::uint8_t>(state >> (8 * i)));
+
+        std::reverse(output.begin() + tableSize, output.end());
+    }
+
+    bool ransDecode(const std::uint8_t* data, size_t size, size_t outputSize, std::vector<std::uint8_t>& output) {
+        output.resize(outputSize);
+        if (outputSize == 0) return true;
+
+        const std::uint8_t* p = data;
+        const std::uint8_t* end = data + size;
+        if (end - p < 2) return false;
+        std::uint16_t usedSymbols = getU16(p);
+        p += 2;
+        if (usedSymbols == 0 || usedSymbols > 256 || static_cast<size_t>(end - p) < usedSymbols * 3u) return false;
+
+        std::array<std::uint32_t, 256> freqs{};
+        for (int i = 0; i < usedSymbols; ++i) {
+            freqs[p[0]] = getU16(p + 1) + 1u;
+            p += 3;
+        }
+
+        // Cumulative lookup from slot to symbol
+        std::array<std::uint32_t, 256> starts{};
+        std::vector<std::uint8_t> slotToSymbol(RANS_SCALE);
+        std::uint32_t cumulative = 0;
+        for (int s = 0; s < 256; ++s) {
+            starts[s] = cumulative;
+            if (cumulative + freqs[s] > RANS_SCALE) return false;
+            std::fill(slotToSymbol.begin() + cumulative, slotToSymbol.begin() + cumulative + freqs[s],
+                      static_cast<std::uint8_t>(s));
+            cumulative += freqs[s];
+        }
+        if (cumulative != RANS_SCALE) return false;
+
+        if (end - p < 4) return false;
+        std::uint32_t state = getU32(p);
+        p += 4;
+
+        for (size_t i = 0; i < outputSize; ++i) {
+            std::uint32_t slot = state & (RANS_SCALE - 1);
+            std::uint8_t s = slotToSymbol[slot];
+            output[i] = s;
+            state = freqs[s] * (state >> RANS_SCALE_BITS) + slot - starts[s];
+            while (state < RANS_LOWER_BOUND) {
+                if (p == end) return i + 1 == outputSize;
+                state = (state << 8) | *p++;
+            }
+        }
+        return true;
+    }
+}
+
+TrajectoryRecorder::TrajectoryRecorder()
+    : recordInterval(1), keyframeInterval(32), queueCapacity(8),
+      running(false), stopRequested(false), recordedFrames(0), droppedFrames(0), bytesWritten(0) {
+}
+
+TrajectoryRecorder::~TrajectoryRecorder() {
+    close();
+}
+
+bool TrajectoryRecorder::open(const std::string& path, int recordInterval, int keyframeInterval,
+                              size_t queueCapacity, const TrajectoryQuantization& quantization) {
+    close();
+
+    file.open(path, std::ios::binary | std::ios::trunc);
+    if (!file) {
+        std::cerr << "Failed to open trajectory file: " << path << std::endl;
+        return false;
+    }
+
+    this->recordInterval = std::max(1, recordInterval);
+    this->keyframeInterval = std::max(1, keyframeInterval);
+    this->queueCapacity = std::max<size_t>(1, queueCapacity);
+    this->quantization = quantization;
+
+    index.clear();
+    previousFrame.clear();
+    recordedFrames = 0;
+    droppedFrames = 0;
+
+    // File header
+    std::vector<std::uint8_t> header;
+    header.insert(header.end(), FILE_MAGIC, FILE_MAGIC + 8);
+    putU32(header, FILE_VERSION);
+    putU32(header, static_cast<std::uint32_t>(this->keyframeInterval));
+    putF32(header, quantization.position);
+    putF32(header, quantization.velocity);
+    putF32(header, quantization.density);
+    putF32(header, quantization.pressure);
+    putF32(header, quantization.mass);
+    file.write(reinterpret_cast<const char*>(header.data()), header.size());
+    bytesWritten = header.size();
+
+    // Start writer thread
+    stopRequested = false;
+    running = true;
+    writerThread = std::thread(&TrajectoryRecorder::writerLoop, this);
+
+    return true;
+}
+
+void TrajectoryRecorder::close() {
+    if (!running) return;
+
+    // Let the writer drain the queue and exit
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        stopRequested = true;
+    }
+    queueCondition.notify_all();
+    writerThread.join();
+    running = false;
+
+    // Index followed by a fixed-size footer pointing at it
+    std::uint64_t indexOffset = bytesWritten;
+    std::vector<std::uint8_t> buffer;
+    putU64(buffer, index.size());
+    for (const auto& entry : index) {
+        putU64(buffer, entry.offset);
+        putU32(buffer, entry.size);
+        putU32(buffer, entry.particleCount);
+        putU64(buffer, static_cast<std::uint64_t>(entry.step));
+        putU8(buffer, entry.keyframe ? 1 : 0);
+    }
+    putU64(buffer, indexOffset);
+    buffer.insert(buffer.end(), INDEX_MAGIC, INDEX_MAGIC + 8);
+    file.write(reinterpret_cast<const char*>(buffer.data()), buffer.size());
+    bytesWritten += buffer.size();
+
+    if (!file) {
+        std::cerr << "Failed to write trajectory index" << std::endl;
+    }
+    file.close();
+
+    queue.clear();
+    freeSnapshots.clear();
+}
+
+void TrajectoryRecorder::record(std::int64_t step, const std::vector<Particle>& particles) {
+    if (!running || step % recordInterval != 0) return;
+
+    // Reserve a recycled buffer, dropping the frame if the writer is behind
+    Snapshot snapshot;
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        if (queue.size() >= queueCapacity) {
+            ++droppedFrames;
+            return;
+        }
+        if (!freeSnapshots.empty()) {
+            snapshot = std::move(freeSnapshots.back());
+            freeSnapshots.pop_back();
+        }
+    }
+
+    // Copy outside the lock so the writer is never blocked on it
+    snapshot.step = step;
+    snapshot.particles.assign(particles.begin(), particles.end());
+
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        queue.push_back(std::move(snapshot));
+    }
+    queueCondition.notify_one();
+}
+
+std::uint64_t TrajectoryRecorder::getRecordedFrames() const {
+    std::lock_guard<std::mutex> lock(queueMutex);
+    return recordedFrames;
+}
+
+std::uint64_t TrajectoryRecorder::getDroppedFrames() const {
+    std::lock_guard<std::mutex> lock(queueMutex);
+    return droppedFrames;
+}
+
+std::uint64_t TrajectoryRecorder::getBytesWritten() const {
+    std::lock_guard<std::mutex> lock(queueMutex);
+    return bytesWritten;
+}
+
+void TrajectoryRecorder::writerLoop() {
+    std::unique_lock<std::mutex> lock(queueMutex);
+    for (;;) {
+        queueCondition.wait(lock, [this] { return stopRequested || !queue.empty(); });
+        if (queue.empty()) break;
+
+        Snapshot snapshot = std::move(queue.front());
+        queue.pop_front();
+
+        lock.unlock();
+        writeFrame(snapshot);
+        lock.lock();
+
+        freeSnapshots.push_back(std::move(snapshot));
+    }
+}
+
+void TrajectoryRecorder::writeFrame(const Snapshot& snapshot) {
+    const std::vector<Particle>& particles = snapshot.particles;
+    size_t n = particles.size();
+
+    // Quantize into planar channels
+    currentFrame.resize(n * CHANNEL_COUNT);
+    for (size_t i = 0; i < n; ++i) {
+        const Particle& p = particles[i];
+        currentFrame[0 * n + i] = quantize(p.position.x, quantization.position);
+        currentFrame[1 * n + i] = quantize(p.position.y, quantization.position);
+        currentFrame[2 * n + i] = quantize(p.velocity.x, quantization.velocity);
+        currentFrame[3 * n + i] = quantize(p.velocity.y, quantization.velocity);
+        currentFrame[4 * n + i] = quantize(p.density, quantization.density);
+        currentFrame[5 * n + i] = quantize(p.pressure, quantization.pressure);
+        currentFrame[6 * n + i] = quantize(p.mass, quantization.mass);
+    }
+
+    // Start a new chunk on the keyframe interval or when the particle count changes
+    bool keyframe = index.empty() || index.size() % keyframeInterval == 0 ||
+                    previousFrame.size() != currentFrame.size();
+
+    // Keyframes delta-code along each channel, other frames against the previous frame
+    rawBuffer.clear();
+    for (int c = 0; c < CHANNEL_COUNT; ++c) {
+        const std::int32_t* current = currentFrame.data() + c * n;
+        const std::int32_t* previous = previousFrame.data() + c * n;
+        for (size_t i = 0; i < n; ++i) {
+            std::int32_t reference = keyframe ? (i > 0 ? current[i - 1] : 0) : previous[i];
+            putVarint(rawBuffer, static_cast<std::int32_t>(static_cast<std::uint32_t>(current[i]) -
+                                                           static_cast<std::uint32_t>(reference)));
+        }
+    }
+    previousFrame.swap(currentFrame);
+
+    // Entropy-code, falling back to raw bytes if that does not help
+    ransEncode(rawBuffer, encodedBuffer);
+    bool entropyCoded = !encodedBuffer.empty() && encodedBuffer.size() < rawBuffer.size();
+    const std::vector<std::uint8_t>& payload = entropyCoded ? encodedBuffer : rawBuffer;
+
+    std::vector<std::uint8_t> header;
+    putU8(header, static_cast<std::uint8_t>((keyframe ? FLAG_KEYFRAME : 0) | (entropyCoded ? FLAG_ENTROPY_CODED : 0)));
+    putU32(header, static_cast<std::uint32_t>(n));
+    putU64(header, static_cast<std::uint64_t>(snapshot.step));
+    putU32(header, static_cast<std::uint32_t>(rawBuffer.size()));
+    putU32(header, static_cast<std::uint32_t>(payload.size()));
+
+    file.write(reinterpret_cast<const char*>(header.data()), header.size());
+    file.write(reinterpret_cast<const char*>(payload.data()), payload.size());
+
+    TrajectoryFrameInfo info;
+    info.size = static_cast<std::uint32_t>(header.size() + payload.size());
+    info.particleCount = static_cast<std::uint32_t>(n);
+    info.step = snapshot.step;
+    info.keyframe = keyframe;
+
+    std::lock_guard<std::mutex> lock(queueMutex);
+    info.offset = bytesWritten;
+    index.push_back(info);
+    bytesWritten += info.size;
+    ++recordedFrames;
+}
+
+TrajectoryReader::TrajectoryReader()
+    : decodedFrameIndex(-1) {
+}
+
+bool TrajectoryReader::open(const std::string& path) {
+    file.close();
+    file.clear();
+    index.clear();
+    decodedFrame.clear();
+    decodedFrameIndex = -1;
+
+    file.open(path, std::ios::binary);
+    if (!file) {
+        std::cerr << "Failed to open trajectory file: " << path << std::endl;
+        return false;
+    }
+
+    // File header
+    std::uint8_t header[FILE_HEADER_SIZE];
+    if (!file.read(reinterpret_cast<char*>(header), sizeof(header)) ||
+        std::memcmp(header, FILE_MAGIC, 8) != 0 || getU32(header + 8) != FILE_VERSION) {
+        std::cerr << "Not a trajectory file: " << path << std::endl;
+        return false;
+    }
+    quantization.position = getF32(header + 16);
+    quantization.velocity = getF32(header + 20);
+    quantization.density = getF32(header + 24);
+    quantization.pressure = getF32(header + 28);
+    quantization.mass = getF32(header + 32);
+
+    // Footer points at the index
+    std::uint8_t footer[FOOTER_SIZE];
+    file.seekg(-static_cast<std::streamoff>(FOOTER_SIZE), std::ios::end);
+    std::streamoff footerOffset = file.tellg();
+    if (!file.read(reinterpret_cast<char*>(footer), sizeof(footer)) ||
+        std::memcmp(footer + 8, INDEX_MAGIC, 8) != 0) {
+        std::cerr << "Trajectory file has no index (recording not closed?): " << path << std::endl;
+        return false;
+    }
+    std::uint64_t indexOffset = getU64(footer);
+
+    // Index
+    std::uint8_t countBytes[8];
+    file.seekg(static_cast<std::streamoff>(indexOffset));
+    if (!file.read(reinterpret_cast<char*>(countBytes), sizeof(countBytes))) return false;
+    std::uint64_t count = getU64(countBytes);
+    if (indexOffset + 8 + count * INDEX_ENTRY_SIZE != static_cast<std::uint64_t>(footerOffset)) {
+        std::cerr << "Corrupt trajectory index: " << path << std::endl;
+        return false;
+    }
+
+    std::vector<std::uint8_t> entries(count * INDEX_ENTRY_SIZE);
+    if (!file.read(reinterpret_cast<char*>(entries.data()), entries.size())) return false;
+
+    index.resize(count);
+    for (size_t i = 0; i < count; ++i) {
+        const std::uint8_t* e = entries.data() + i * INDEX_ENTRY_SIZE;
+        index[i].offset = getU64(e);
+        index[i].size = getU32(e + 8);
+        index[i].particleCount = getU32(e + 12);
+        index[i].step = static_cast<std::int64_t>(getU64(e + 16));
+        index[i].keyframe = e[24] != 0;
+    }
+
+    if (!index.empty() && !index.front().keyframe) {
+        std::cerr << "Corrupt trajectory index: " << path << std::endl;
+        index.clear();
+        return false;
+    }
+
+    return true;
+}
+
+bool TrajectoryReader::readFrame(size_t frame, std::vector<Particle>& particles) {
+    if (frame >= index.size()) return false;
+
+    // Decode from the nearest keyframe, or continue from the cached frame
+    size_t keyframe = frame;
+    while (!index[keyframe].keyframe) --keyframe;
+
+    size_t start = keyframe;
+    if (decodedFrameIndex >= static_cast<long long>(keyframe) && decodedFrameIndex <= static_cast<long long>(frame)) {
+        start = static_cast<size_t>(decodedFrameIndex) + 1;
+    }
+
+    for (size_t f = start; f <= frame; ++f) {
+        if (!decodeFrame(f)) {
+            decodedFrameIndex = -1;
+            return false;
+        }
+    }
+
+    // Dequantize
+    size_t n = index[frame].particleCount;
+    particles.resize(n);
+    for (size_t i = 0; i < n; ++i) {
+        Particle& p = particles[i];
+        p.position.x = decodedFrame[0 * n + i] * quantization.position;
+        p.position.y = decodedFrame[1 * n + i] * quantization.position;
+        p.velocity.x = decodedFrame[2 * n + i] * quantization.velocity;
+        p.velocity.y = decodedFrame[3 * n + i] * quantization.velocity;
+        p.density = decodedFrame[4 * n + i] * quantization.density;
+        p.pressure = decodedFrame[5 * n + i] * quantization.pressure;
+        p.mass = decodedFrame[6 * n + i] * quantization.mass;
+        p.resetForce();
+    }
+
+    return true;
+}
+
+bool TrajectoryReader::decodeFrame(size_t frame) {
+    const TrajectoryFrameInfo& info = index[frame];
+    if (info.size < FRAME_HEADER_SIZE) return false;
+
+    recordBuffer.resize(info.size);
+    file.clear();
+    file.seekg(static_cast<std::streamoff>(info.offset));
+    if (!file.read(reinterpret_cast<char*>(recordBuffer.data()), recordBuffer.size())) return false;
+
+    const std::uint8_t* header = recordBuffer.data();
+    std::uint8_t flags = header[0];
+    std::uint32_t n = getU32(header + 1);
+    std::uint32_t rawSize = getU32(header + 13);
+    std::uint32_t payloadSize = getU32(header + 17);
+    bool keyframe = (flags & FLAG_KEYFRAME) != 0;
+    if (n != info.particleCount || payloadSize != info.size - FRAME_HEADER_SIZE) return false;
+
+    const std::uint8_t* payload = header + FRAME_HEADER_SIZE;
+    const std::uint8_t* raw = payload;
+    if (flags & FLAG_ENTROPY_CODED) {
+        if (!ransDecode(payload, payloadSize, rawSize, rawBuffer)) return false;
+        raw = rawBuffer.data();
+    } else if (rawSize != payloadSize) {
+        return false;
+    }
+
+    size_t values = static_cast<size_t>(n) * CHANNEL_COUNT;
+    if (!keyframe && decodedFrame.size() != values) return false;
+    decodedFrame.resize(values);
+
+    // Undo delta coding
+    const std::uint8_t* p = raw;
+    const std::uint8_t* end = raw + rawSize;
+    for (int c = 0; c < CHANNEL_COUNT; ++c) {
+        std::int32_t* channel = decodedFrame.data() + static_cast<size_t>(c) * n;
+        for (size_t i = 0; i < n; ++i) {
+            std::int32_t delta;
+            if (!getVarint(p, end, delta)) return false;
+            std::int32_t reference = keyframe ? (i > 0 ? channel[i - 1] : 0) : channel[i];
+            channel[i] = static_cast<std::int32_t>(static_cast<std::uint32_t>(reference) +
+                                                   static_cast<std::uint32_t>(delta));
+        }
+    }
+
+    decodedFrameIndex = static_cast<long long>(frame);
+    return true;
+}
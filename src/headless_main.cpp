@@ -0,0 +1,217 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+
+#include "AutoTuner.h"
+#include "SharedFrameExporter.h"
+#include "Simulation.h"
+#include "SoftwareRenderer.h"
+#include "Trajectory.h"
+
+// Headless runner: steps the simulation and renders frames on the CPU.
+// Frames go to numbered PNG/PPM files or as raw RGB24 to stdout, e.g.
+//   sph_headless --output raw | ffmpeg -f rawvideo -pix_fmt rgb24 -s 800x600 -r 60 -i - out.mp4
+
+namespace {
+    struct Options {
+        int width = 800;
+        int height = 600;
+        int particles = 1000;
+        int steps = 600;
+        int frameInterval = 1;
+        int threads = 0;
+        float dt = 0.01f;
+        float smoothingRadius = -1.0f;
+        FrameOutput output = FrameOutput::PNG;
+        std::string pattern = "frame_%05d";
+        std::string trajectory;
+        std::string sharedMemory;
+        InitMode initMode = InitMode::Lattice;
+        int relaxationSteps = -1;
+        bool autotune = false;
+        bool retune = false;
+        bool tuneReorder = false;
+    };
+
+    void printUsage(const char* program) {
+        std::cerr << "Usage: " << program << " [options]\n"
+                  << "  --width N              Framebuffer and domain width (default 800)\n"
+                  << "  --height N             Framebuffer and domain height (default 600)\n"
+                  << "  --particles N          Number of particles (default 1000)\n"
+                  << "  --steps N              Number of simulation steps (default 600)\n"
+                  << "  --dt T                 Time step (default 0.01)\n"
+                  << "  --smoothing-radius H   SPH smoothing radius\n"
+                  << "  --frame-interval N     Render every N steps (default 1)\n"
+                  << "  --threads N            Worker threads, 0 = all cores (default 0)\n"
+                  << "  --output png|ppm|raw|none  Frame output (default png)\n"
+                  << "  --pattern P            printf-style frame path (default frame_%05d)\n"
+                  << "  --init random|lattice|poisson  Initial particle placement (default lattice)\n"
+                  << "  --relax N              Relaxation steps after placement\n"
+                  << "  --record PATH          Record a trajectory file\n"
+                  << "  --shm NAME             Publish frames to shared memory (e.g. /sph_frames)\n"
+                  << "  --autotune             Use cached or calibrated performance settings\n"
+                  << "  --retune               Recalibrate even if settings are cached\n"
+                  << "  --tune-reorder         Also tune particle reordering (permutes particle order)\n";
+    }
+
+    bool parseOptions(int argc, char** argv, Options& options) {
+        for (int i = 1; i < argc; ++i) {
+            std::string arg = argv[i];
+            if (arg == "--help" || arg == "-h") return false;
+            if (arg == "--autotune") {
+                options.autotune = true;
+                continue;
+            }
+            if (arg == "--retune") {
+                options.autotune = options.retune = true;
+                continue;
+            }
+            if (arg == "--tune-reorder") {
+                options.tuneReorder = true;
+                continue;
+            }
+            if (i + 1 >= argc) {
+                std::cerr << "Missing value for " << arg << std::endl;
+                return false;
+            }
+            const char* value = argv[++i];
+
+            if (arg == "--width") options.width = std::atoi(value);
+            else if (arg == "--height") options.height = std::atoi(value);
+            else if (arg == "--particles") options.particles = std::atoi(value);
+            else if (arg == "--steps") options.steps = std::atoi(value);
+            else if (arg == "--dt") options.dt = static_cast<float>(std::atof(value));
+            else if (arg == "--smoothing-radius") options.smoothingRadius = static_cast<float>(std::atof(value));
+            else if (arg == "--frame-interval") options.frameInterval = std::max(1, std::atoi(value));
+            else if (arg == "--threads") options.threads = std::atoi(value);
+            else if (arg == "--pattern") options.pattern = value;
+            else if (arg == "--record") options.trajectory = value;
+            else if (arg == "--shm") options.sharedMemory = value;
+            else if (arg == "--relax") options.relaxationSteps = std::atoi(value);
+            else if (arg == "--init") {
+                if (!std::strcmp(value, "random")) options.initMode = InitMode::Random;
+                else if (!std::strcmp(value, "lattice")) options.initMode = InitMode::Lattice;
+                else if (!std::strcmp(value, "poisson")) options.initMode = InitMode::PoissonDisk;
+                else {
+                    std::cerr << "Unknown initial state: " << value << std::endl;
+                    return false;
+                }
+            } else if (arg == "--output") {
+                if (!std::strcmp(value, "png")) options.output = FrameOutput::PNG;
+                else if (!std::strcmp(value, "ppm")) options.output = FrameOutput::PPM;
+                else if (!std::strcmp(value, "raw")) options.output = FrameOutput::RawStdout;
+                else if (!std::strcmp(value, "none")) options.output = FrameOutput::None;
+                else {
+                    std::cerr << "Unknown output format: " << value << std::endl;
+                    return false;
+                }
+            } else {
+                std::cerr << "Unknown option: " << arg << std::endl;
+                return false;
+            }
+        }
+        return true;
+    }
+}
+
+int main(int argc, char** argv) {
+    Options options;
+    if (!parseOptions(argc, argv, options)) {
+        printUsage(argv[0]);
+        return -1;
+    }
+
+    // Create renderer
+    SoftwareRenderer renderer(options.width, options.height, options.threads);
+    if (!renderer.initialize()) {
+        std::cerr << "Failed to initialize renderer" << std::endl;
+        return -1;
+    }
+    if (!renderer.setOutput(options.output, options.pattern)) {
+        return -1;
+    }
+
+    // Create simulation
+    Simulation simulation(static_cast<float>(options.width), static_cast<float>(options.height));
+    if (options.smoothingRadius > 0.0f) {
+        simulation.setSmoothingRadius(options.smoothingRadius);
+    }
+    simulation.setInitMode(options.initMode);
+    if (options.relaxationSteps >= 0) {
+        simulation.setRelaxationSteps(options.relaxationSteps);
+    }
+    if (options.threads > 0) {
+        simulation.setThreadCount(options.threads);
+    }
+
+    auto initStart = std::chrono::high_resolution_clock::now();
+    simulation.initialize(options.particles);
+    auto initEnd = std::chrono::high_resolution_clock::now();
+    std::cerr << "Initialization Time: " << std::chrono::duration<float>(initEnd - initStart).count() * 1000.0f
+              << " ms" << std::endl;
+
+    // Pick performance settings for this machine and scene; an explicit
+    // thread count is kept
+    if (options.autotune) {
+        AutoTuner tuner;
+        tuner.setTuneThreads(options.threads <= 0);
+        tuner.setTuneReorder(options.tuneReorder);
+        tuner.tune(simulation, options.dt, options.retune);
+    }
+
+    // Optional trajectory recording
+    TrajectoryRecorder recorder;
+    if (!options.trajectory.empty() && !recorder.open(options.trajectory, options.frameInterval)) {
+        return -1;
+    }
+
+    // Optional shared memory export
+    SharedFrameExporter exporter;
+    if (!options.sharedMemory.empty() &&
+        !exporter.open(options.sharedMemory, static_cast<uint32_t>(simulation.getParticles().size()))) {
+        return -1;
+    }
+
+    // Main loop
+    float simulationTime = 0.0f;
+    float renderTime = 0.0f;
+    for (int step = 0; step < options.steps; ++step) {
+        auto simStart = std::chrono::high_resolution_clock::now();
+        simulation.update(options.dt);
+        auto simEnd = std::chrono::high_resolution_clock::now();
+        simulationTime += std::chrono::duration<float>(simEnd - simStart).count();
+
+        recorder.record(step, simulation.getParticles());
+        if (exporter.isOpen()) {
+            exporter.publish(simulation);
+        }
+
+        if (step % options.frameInterval == 0) {
+            auto renderStart = std::chrono::high_resolution_clock::now();
+            bool written = renderer.render(simulation.getParticles());
+            auto renderEnd = std::chrono::high_resolution_clock::now();
+            renderTime += std::chrono::duration<float>(renderEnd - renderStart).count();
+
+            // A job whose frames are not written has failed
+            if (!written) {
+                std::cerr << "Stopping after failed frame " << renderer.getFrameNumber() - 1 << std::endl;
+                recorder.close();
+                return -1;
+            }
+        }
+    }
+    recorder.close();
+
+    // Performance summary (stderr keeps stdout clean for raw frames)
+    int frames = renderer.getFrameNumber();
+    std::cerr << "Steps: " << options.steps << ", frames: " << frames << std::endl;
+    std::cerr << "Simulation Time: " << (options.steps > 0 ? simulationTime * 1000.0f / options.steps : 0.0f)
+              << " ms/step" << std::endl;
+    std::cerr << "Render Time: " << (frames > 0 ? renderTime * 1000.0f / frames : 0.0f)
+              << " ms/frame" << std::endl;
+
+    return 0;
+}
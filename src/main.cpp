@@ -9,6 +9,9 @@
 
 #include "Simulation.h"
 #include "Renderer.h"
+#include "Trajectory.h"
+#include "AutoTuner.h"
+#include "SharedFrameExporter.h"
 
 // Window dimensions
 const int WINDOW_WIDTH = 800;
@@ -18,6 +21,12 @@ const int WINDOW_HEIGHT = 600;
 const float SIM_WIDTH = static_cast<float>(WINDOW_WIDTH);
 const float SIM_HEIGHT = static_cast<float>(WINDOW_HEIGHT);
 
+// Trajectory output file
+const char* TRAJECTORY_PATH = "trajectory.sphtraj";
+
+// Shared memory segment for frame export
+const char* SHARED_MEMORY_NAME = "/sph_frames";
+
 // Target frame rate
 const float TARGET_FPS = 60.0f;
 const float TARGET_FRAME_TIME = 1.0f / TARGET_FPS;
@@ -37,6 +46,13 @@ int main() {
     int numParticles = 1000;
     simulation.initialize(numParticles);
     
+    // Pack render buffers inside the simulation's fused pass
+    simulation.setRenderPacking(true);
+    
+    // Use auto-tuned performance settings if this machine has calibrated this scene
+    AutoTuner tuner;
+    tuner.applyCached(simulation);
+    
     // Setup ImGui
     IMGUI_CHECKVERSION();
     ImGui::CreateContext();
@@ -61,6 +77,16 @@ int main() {
     float simulationTime = 0.0f;
     float renderTime = 0.0f;
     
+    // Trajectory recording
+    TrajectoryRecorder recorder;
+    bool recordTrajectory = false;
+    int recordInterval = 10;
+    long long step = 0;
+    
+    // Shared memory frame export
+    SharedFrameExporter exporter;
+    bool exportFrames = false;
+    
     // Main loop
     while (!renderer.shouldClose()) {
         // Process input
@@ -78,12 +104,22 @@ int main() {
         ImGui::Begin("Simulation Parameters");
         
         // Particle count
+        // Re-initialize once the slider is released; every value while dragging
+        // would place, relax and cache another initial state
         static int newParticleCount = numParticles;
-        if (ImGui::SliderInt("Particle Count", &newParticleCount, 100, 5000)) {
-            if (newParticleCount != numParticles) {
-                numParticles = newParticleCount;
-                simulation.initialize(numParticles);
-            }
+        ImGui::SliderInt("Particle Count", &newParticleCount, 100, 5000);
+        if (ImGui::IsItemDeactivatedAfterEdit() && newParticleCount != numParticles) {
+            numParticles = newParticleCount;
+            simulation.initialize(numParticles);
+            tuner.applyCached(simulation);
+        }
+        
+        // Initial state
+        static int initMode = static_cast<int>(simulation.getInitMode());
+        const char* initModes[] = {"Random", "Lattice", "Poisson Disk"};
+        if (ImGui::Combo("Initial State", &initMode, initModes, 3)) {
+            simulation.setInitMode(static_cast<InitMode>(initMode));
+            simulation.initialize(numParticles);
         }
         
         // Time step
@@ -119,9 +155,49 @@ int main() {
             simulation.setDampingCoefficient(dampingCoefficient);
         }
         
+        // Trajectory recording
+        ImGui::Separator();
+        ImGui::Text("Recording");
+        // The interval is fixed when recording starts
+        ImGui::BeginDisabled(recorder.isOpen());
+        ImGui::SliderInt("Record Interval", &recordInterval, 1, 100);
+        ImGui::EndDisabled();
+        if (ImGui::Checkbox("Record Trajectory", &recordTrajectory)) {
+            if (recordTrajectory) {
+                recordTrajectory = recorder.open(TRAJECTORY_PATH, recordInterval);
+            } else {
+                recorder.close();
+            }
+        }
+        if (recorder.isOpen()) {
+            ImGui::Text("Frames: %llu (dropped %llu), %.1f MB",
+                        static_cast<unsigned long long>(recorder.getRecordedFrames()),
+                        static_cast<unsigned long long>(recorder.getDroppedFrames()),
+                        recorder.getBytesWritten() / (1024.0 * 1024.0));
+        }
+        
+        // Shared memory export
+        if (ImGui::Checkbox("Shared Memory Export", &exportFrames)) {
+            if (exportFrames) {
+                exportFrames = exporter.open(SHARED_MEMORY_NAME, static_cast<uint32_t>(numParticles));
+            } else {
+                exporter.close();
+            }
+        }
+        if (exporter.isOpen()) {
+            ImGui::Text("Published: %llu frames to %s",
+                        static_cast<unsigned long long>(exporter.getFrameCount()), SHARED_MEMORY_NAME);
+        }
+        
         // Performance metrics
         ImGui::Separator();
         ImGui::Text("Performance");
+        ImGui::Text("Threads: %d, Tile: %d, Cell Scale: %.2f, Reorder: %d",
+                    simulation.getThreadCount(), simulation.getTileSize(),
+                    simulation.getCellSizeScale(), simulation.getReorderInterval());
+        if (ImGui::Button("Auto-Tune")) {
+            tuner.tune(simulation, dt, true);
+        }
         ImGui::Text("Frame Time: %.3f ms (%.1f FPS)", frameTime * 1000.0f, 1.0f / frameTime);
         ImGui::Text("Simulation Time: %.3f ms", simulationTime * 1000.0f);
         ImGui::Text("Render Time: %.3f ms", renderTime * 1000.0f);
@@ -134,9 +210,17 @@ int main() {
         auto simEnd = std::chrono::high_resolution_clock::now();
         simulationTime = std::chrono::duration<float>(simEnd - simStart).count();
         
+        // Snapshot for the trajectory writer thread
+        recorder.record(step++, simulation.getParticles());
+        
+        // Publish to co-located readers (never waits for them)
+        if (exporter.isOpen()) {
+            exporter.publish(simulation);
+        }
+        
         // Render particles
         auto renderStart = std::chrono::high_resolution_clock::now();
-        renderer.render(simulation.getParticles());
+        renderer.render(simulation.getPackedPositions(), simulation.getPackedColors());
         
         // Render ImGui
         ImGui::Render();
@@ -156,6 +240,9 @@ int main() {
         }
     }
     
+    // Finish the trajectory file
+    recorder.close();
+    
     // Cleanup ImGui
     ImGui_ImplOpenGL3_Shutdown();
     ImGui_ImplGlfw_Shutdown();
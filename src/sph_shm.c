@@ -0,0 +1,122 @@
+/* Reader side of the shared-memory frame export (see sph_shm.h). */
+#define _POSIX_C_SOURCE 200809L
+
+#include "sph_shm.h"
+
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+struct sph_shm_reader {
+    const unsigned char* base;
+    size_t size;
+    const sph_shm_header* header;
+};
+
+static const sph_shm_slot* slot_for(const sph_shm_reader* reader, uint64_t frame_id) {
+    const sph_shm_header* header = reader->header;
+    uint64_t index = frame_id % header->slot_count;
+    return (const sph_shm_slot*)(reader->base + header->data_offset + index * header->slot_size);
+}
+
+sph_shm_reader* sph_shm_attach(const char* name) {
+    if (!name) return NULL;
+
+    int fd = shm_open(name, O_RDONLY, 0);
+    if (fd < 0) return NULL;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(sph_shm_header)) {
+        close(fd);
+        return NULL;
+    }
+
+    void* base = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED) return NULL;
+
+    /* The producer stores the magic last, once the header is complete */
+    const sph_shm_header* header = (const sph_shm_header*)base;
+    uint64_t magic = __atomic_load_n(&header->magic, __ATOMIC_ACQUIRE);
+    if (magic != SPH_SHM_MAGIC || header->version != SPH_SHM_VERSION || header->slot_count == 0 ||
+        header->data_offset + (uint64_t)header->slot_count * header->slot_size > (uint64_t)st.st_size) {
+        munmap(base, (size_t)st.st_size);
+        return NULL;
+    }
+
+    sph_shm_reader* reader = (sph_shm_reader*)malloc(sizeof(sph_shm_reader));
+    if (!reader) {
+        munmap(base, (size_t)st.st_size);
+        return NULL;
+    }
+    reader->base = (const unsigned char*)base;
+    reader->size = (size_t)st.st_size;
+    reader->header = header;
+    return reader;
+}
+
+void sph_shm_detach(sph_shm_reader* reader) {
+    if (!reader) return;
+    munmap((void*)reader->base, reader->size);
+    free(reader);
+}
+
+const sph_shm_header* sph_shm_get_header(const sph_shm_reader* reader) {
+    return reader ? reader->header : NULL;
+}
+
+int sph_shm_acquire(sph_shm_reader* reader, uint64_t frame_id, sph_shm_frame* frame) {
+    if (!reader || !frame) return SPH_SHM_ERROR;
+
+    const sph_shm_header* header = reader->header;
+    if (__atomic_load_n(&header->closed, __ATOMIC_ACQUIRE)) return SPH_SHM_CLOSED;
+
+    uint64_t latest = __atomic_load_n(&header->latest_frame, __ATOMIC_ACQUIRE);
+    if (latest == 0 || frame_id >= latest) return SPH_SHM_NO_FRAME;
+
+    const sph_shm_slot* slot = slot_for(reader, frame_id);
+    uint64_t sequence = __atomic_load_n(&slot->sequence, __ATOMIC_ACQUIRE);
+    if (sequence == 2 * frame_id + 1) return SPH_SHM_RETRY;
+    if (sequence != 2 * frame_id + 2) return SPH_SHM_NO_FRAME;
+
+    /* Copy the small slot header; particle data stays in place */
+    frame->frame_id = frame_id;
+    frame->particle_count = slot->particle_count;
+    frame->params = slot->params;
+    frame->layout = header->layout;
+    frame->particles = (const unsigned char*)slot + SPH_SHM_SLOT_HEADER_SIZE;
+    frame->sequence = sequence;
+    frame->slot = slot;
+
+    /* Make sure the header copy is not torn */
+    if (!sph_shm_validate(reader, frame)) return SPH_SHM_RETRY;
+    if (frame->particle_count > header->max_particles) return SPH_SHM_RETRY;
+    return SPH_SHM_OK;
+}
+
+int sph_shm_latest(sph_shm_reader* reader, sph_shm_frame* frame) {
+    if (!reader || !frame) return SPH_SHM_ERROR;
+
+    /* The newest frame can be overwritten only after slot_count more frames,
+       so a few retries are enough unless the reader is descheduled */
+    for (int attempt = 0; attempt < 8; ++attempt) {
+        uint64_t latest = __atomic_load_n(&reader->header->latest_frame, __ATOMIC_ACQUIRE);
+        if (__atomic_load_n(&reader->header->closed, __ATOMIC_ACQUIRE)) return SPH_SHM_CLOSED;
+        if (latest == 0) return SPH_SHM_NO_FRAME;
+
+        int result = sph_shm_acquire(reader, latest - 1, frame);
+        if (result != SPH_SHM_RETRY && result != SPH_SHM_NO_FRAME) return result;
+    }
+    return SPH_SHM_RETRY;
+}
+
+int sph_shm_validate(const sph_shm_reader* reader, const sph_shm_frame* frame) {
+    if (!reader || !frame || !frame->slot) return 0;
+
+    /* Order all reads of the frame before re-reading the sequence */
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    return __atomic_load_n(&frame->slot->sequence, __ATOMIC_RELAXED) == frame->sequence;
+}